@@ -0,0 +1,279 @@
+// Benchmarks of the emulator core: single instructions, DXYN, whole ROMs and
+// the screen comparisons.
+
+#include <algorithm>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "chip8.h"
+#include "common.h"
+#include "harness.h"
+#include "jit_x64.h"
+#include "rom.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr u32 INSTRUCTIONS_PER_FRAME = 10;
+
+struct Instruction {
+    const char *name;
+    u16 opcode;
+};
+
+// one representative opcode per implemented handler
+constexpr Instruction INSTRUCTIONS[] = {
+    {"0NNN", 0x0123}, {"00E0", 0x00E0}, {"1NNN", 0x1200}, {"6XNN", 0x6A42},
+    {"7XNN", 0x7A01}, {"8XY0", 0x8AB0}, {"8XY1", 0x8AB1}, {"8XY2", 0x8AB2},
+    {"8XY3", 0x8AB3}, {"ANNN", 0xA300}, {"FX07", 0xFA07}, {"FX15", 0xFA15},
+    {"FX18", 0xFA18}, {"FX33", 0xFA33}, {"FX55", 0xF755}, {"FX65", 0xF765},
+    {"unknown", 0x5121},
+};
+
+const char *backend_name(Chip8::Backend backend) {
+    switch (backend) {
+    case Chip8::Backend::interpreter:
+        return "interpreter";
+    case Chip8::Backend::block_cache:
+        return "block_cache";
+    case Chip8::Backend::jit:
+        return "jit";
+    }
+    return "unknown";
+}
+
+std::vector<Chip8::Backend> backends() {
+    std::vector<Chip8::Backend> backends{Chip8::Backend::interpreter,
+                                         Chip8::Backend::block_cache};
+    if (Jit::supported()) {
+        backends.push_back(Chip8::Backend::jit);
+    }
+    return backends;
+}
+
+// a deterministic mix of the implemented instructions, leaving out DXYN so
+// drawing does not dominate
+std::vector<u16> instruction_mix() {
+    constexpr u16 PATTERNS[] = {0x6000, 0x7000, 0x8000, 0x8001, 0x8002,
+                                0x8003, 0xA000, 0xF007, 0xF015, 0xF018,
+                                0xF033, 0xF055, 0xF065, 0x00E0};
+    constexpr u16 FIELDS[] = {0x0FFF, 0x0FFF, 0x0FF0, 0x0FF0, 0x0FF0,
+                              0x0FF0, 0x03FF, 0x0F00, 0x0F00, 0x0F00,
+                              0x0F00, 0x0700, 0x0700, 0x0000};
+    constexpr auto PATTERN_COUNT = sizeof(PATTERNS) / sizeof(PATTERNS[0]);
+
+    std::vector<u16> opcodes(4096);
+    u32 seed = 0x2545F491;
+    for (auto &opcode : opcodes) {
+        seed = seed * 1664525 + 1013904223;
+        const auto which = (seed >> 16) % PATTERN_COUNT;
+        opcode = PATTERNS[which] | (static_cast<u16>(seed) & FIELDS[which]);
+    }
+    return opcodes;
+}
+
+// register arithmetic, a store and a draw in a loop
+const std::vector<u8> SYNTHETIC_ROM{
+    0x60, 0x00, // 200: V0 = 0
+    0x61, 0x00, // 202: V1 = 0
+    0xA0, 0x50, // 204: I = font start
+    0xD0, 0x15, // 206: draw 5 rows at V0, V1
+    0x70, 0x05, // 208: V0 += 5
+    0x71, 0x03, // 20A: V1 += 3
+    0x83, 0x01, // 20C: V3 |= V0
+    0x84, 0x13, // 20E: V4 ^= V1
+    0x85, 0x32, // 210: V5 &= V3
+    0xA3, 0x00, // 212: I = 300
+    0xF3, 0x33, // 214: store the BCD of V3
+    0x12, 0x04, // 216: jump 204
+};
+
+// runs @param rom for @param instructions in frames, starting over if it
+// halts
+void run_rom(Chip8 &chip8, const Chip8::State &initial, u64 instructions) {
+    while (instructions > 0) {
+        const auto frame = static_cast<u32>(
+            std::min<u64>(instructions, INSTRUCTIONS_PER_FRAME));
+        const auto executed = chip8.run(frame);
+        chip8.tick_timers();
+        if (executed < frame) {
+            chip8.load_state(initial);
+        }
+        instructions -= std::max(executed, 1u);
+    }
+}
+
+void rom_benchmarks(Bench &bench, const std::string &name,
+                    std::span<const u8> rom) {
+    for (const auto backend : backends()) {
+        bench.run("rom/" + name + "/" + backend_name(backend), 1,
+                  [rom, backend](u64 iterations) {
+                      Chip8 chip8;
+                      chip8.set_backend(backend);
+                      chip8.load_rom(rom);
+                      run_rom(chip8, chip8.save_state(), iterations);
+                      keep(chip8.screen_hash());
+                  });
+    }
+    // the block cache without superinstructions, to compare against
+    bench.run("rom/" + name + "/block_cache_unfused", 1,
+              [rom](u64 iterations) {
+                  Chip8 chip8;
+                  chip8.set_backend(Chip8::Backend::block_cache);
+                  chip8.set_fusion(false);
+                  chip8.load_rom(rom);
+                  run_rom(chip8, chip8.save_state(), iterations);
+                  keep(chip8.screen_hash());
+              });
+}
+
+void instruction_benchmarks(Bench &bench) {
+    for (const auto &instruction : INSTRUCTIONS) {
+        bench.run(std::string{"execute/"} + instruction.name, 1,
+                  [opcode = instruction.opcode](u64 iterations) {
+                      Chip8 chip8;
+                      for (auto i = 0u; i < iterations; ++i) {
+                          chip8.execute(opcode);
+                      }
+                      keep(chip8.save_state().V);
+                  });
+    }
+    // calls and returns only make sense in pairs
+    bench.run("execute/2NNN+00EE", 2, [](u64 iterations) {
+        Chip8 chip8;
+        for (auto i = 0u; i < iterations; ++i) {
+            chip8.execute(0x2400);
+            chip8.execute(0x00EE);
+        }
+        keep(chip8.pc());
+    });
+
+    const auto mix = instruction_mix();
+    bench.run("dispatch/table", 1, [&mix](u64 iterations) {
+        Chip8 chip8;
+        for (auto i = 0u; i < iterations; ++i) {
+            chip8.execute(mix[i % mix.size()]);
+        }
+        keep(chip8.save_state().V);
+    });
+    bench.run("dispatch/switch", 1, [&mix](u64 iterations) {
+        Chip8 chip8;
+        for (auto i = 0u; i < iterations; ++i) {
+            chip8.execute_switch(mix[i % mix.size()]);
+        }
+        keep(chip8.save_state().V);
+    });
+}
+
+void draw_benchmarks(Bench &bench) {
+    struct Position {
+        const char *name;
+        u8 x;
+        u8 y;
+    };
+    constexpr Position POSITIONS[] = {
+        {"aligned", 0, 0}, {"unaligned", 3, 7}, {"clipped", 60, 30}};
+
+    for (const auto height : {1, 5, 15}) {
+        for (const auto &position : POSITIONS) {
+            bench.run("DXYN/height" + std::to_string(height) + "/" +
+                          position.name,
+                      1, [height, position](u64 iterations) {
+                          Chip8 chip8;
+                          chip8.execute(0xA050);
+                          chip8.execute(0x6000 | position.x);
+                          chip8.execute(0x6100 | position.y);
+                          const auto opcode = static_cast<u16>(0xD010 | height);
+                          for (auto i = 0u; i < iterations; ++i) {
+                              chip8.execute(opcode);
+                          }
+                          keep(chip8.screen());
+                      });
+        }
+    }
+}
+
+void throughput_benchmarks(Bench &bench, std::string_view rom_dir) {
+    bench.run("cycle/synthetic", 1, [](u64 iterations) {
+        Chip8 chip8;
+        chip8.load_rom(SYNTHETIC_ROM);
+        for (auto i = 0u; i < iterations; ++i) {
+            chip8.cycle();
+        }
+        keep(chip8.screen_hash());
+    });
+    rom_benchmarks(bench, "synthetic", SYNTHETIC_ROM);
+
+    if (rom_dir.empty()) {
+        return;
+    }
+    std::vector<fs::path> roms;
+    for (const auto &entry : fs::directory_iterator{rom_dir}) {
+        if (entry.is_regular_file() && entry.path().extension() == ".ch8") {
+            roms.push_back(entry.path());
+        }
+    }
+    std::ranges::sort(roms);
+    for (const auto &path : roms) {
+        const auto rom = MappedRom::open(path);
+        if (!rom.empty()) {
+            rom_benchmarks(bench, path.stem().string(), rom.bytes());
+        }
+    }
+}
+
+void screen_benchmarks(Bench &bench) {
+    Chip8 chip8;
+    chip8.load_rom(SYNTHETIC_ROM);
+    chip8.run(1000);
+    const auto same = chip8.screen();
+    auto different = same;
+    different.back() ^= 0x1u;
+
+    auto bitmap = Chip8::ScreenBitmap{};
+    for (auto row = 0u; row < Chip8::SCREEN_HEIGHT; ++row) {
+        for (auto col = 0u; col < Chip8::SCREEN_WIDTH; ++col) {
+            bitmap[row][col] = Chip8::pixel(same, row, col);
+        }
+    }
+
+    bench.run("screen_equal/equal", 1, [&chip8, &same](u64 iterations) {
+        for (auto i = 0u; i < iterations; ++i) {
+            keep(chip8.screen_equal(same));
+        }
+    });
+    bench.run("screen_equal/different", 1,
+              [&chip8, &different](u64 iterations) {
+                  for (auto i = 0u; i < iterations; ++i) {
+                      keep(chip8.screen_equal(different));
+                  }
+              });
+    bench.run("screen_equal/bitmap", 1, [&chip8, &bitmap](u64 iterations) {
+        for (auto i = 0u; i < iterations; ++i) {
+            keep(chip8.screen_equal(bitmap));
+        }
+    });
+    bench.run("screen_difference", 1, [&chip8, &different](u64 iterations) {
+        for (auto i = 0u; i < iterations; ++i) {
+            keep(chip8.screen_difference(different));
+        }
+    });
+    bench.run("screen_difference/bitmap", 1,
+              [&chip8, &bitmap](u64 iterations) {
+                  for (auto i = 0u; i < iterations; ++i) {
+                      keep(chip8.screen_difference(bitmap));
+                  }
+              });
+}
+
+} // namespace
+
+void core_benchmarks(Bench &bench, std::string_view rom_dir) {
+    instruction_benchmarks(bench);
+    draw_benchmarks(bench);
+    throughput_benchmarks(bench, rom_dir);
+    screen_benchmarks(bench);
+}
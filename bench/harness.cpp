@@ -0,0 +1,59 @@
+#include "harness.h"
+
+#include <cstdio>
+
+#include "spdlog/spdlog.h"
+
+namespace {
+
+// names come from ROM file names too, escape them
+std::string escape(std::string_view text) {
+    std::string escaped;
+    for (const auto c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char code[8];
+            std::snprintf(code, sizeof(code), "\\u%04x", c);
+            escaped += code;
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+void Bench::record(const std::string &name, u64 iterations,
+                   double ns_per_op) {
+    spdlog::info("{:<48} {:>12.3f} ns/op", name, ns_per_op);
+    results_.push_back({name, iterations, ns_per_op});
+}
+
+std::string Bench::json() const {
+#ifdef NDEBUG
+    constexpr auto assertions = "false";
+#else
+    constexpr auto assertions = "true";
+#endif
+    std::string json = "{\n  \"build\": {\"compiler\": \"" +
+                       escape(__VERSION__) + "\", \"build_type\": \"" +
+                       escape(CHIP8_BUILD_TYPE) +
+                       "\", \"assertions\": " + assertions +
+                       "},\n  \"benchmarks\": [";
+    for (auto i = 0u; i < results_.size(); ++i) {
+        const auto &result = results_[i];
+        char numbers[96];
+        std::snprintf(numbers, sizeof(numbers),
+                      "\"iterations\": %llu, \"ns_per_op\": %.4f",
+                      static_cast<unsigned long long>(result.iterations),
+                      result.ns_per_op);
+        json += i == 0 ? "\n" : ",\n";
+        json += "    {\"name\": \"" + escape(result.name) + "\", " + numbers +
+                "}";
+    }
+    json += "\n  ]\n}\n";
+    return json;
+}
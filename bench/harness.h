@@ -0,0 +1,77 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.h"
+
+/// Keeps @param value alive so the work producing it is not optimized away
+template <typename T> inline void keep(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Times benchmark bodies and collects the results.
+///
+/// A body takes an iteration count and runs that many iterations. The count
+/// doubles until one run takes at least MIN_RUN_TIME, then the best of RUNS
+/// runs at that count is kept.
+class Bench {
+  public:
+    struct Result {
+        std::string name;
+        u64 iterations = 0;
+        double ns_per_op = 0.0;
+    };
+
+    /// only runs benchmarks whose name contains @param filter
+    explicit Bench(std::string filter) : filter_{std::move(filter)} {}
+
+    /// times @param body, each iteration doing @param ops_per_iteration ops
+    template <typename Body>
+    void run(const std::string &name, u64 ops_per_iteration, Body body) {
+        if (name.find(filter_) == std::string::npos) {
+            return;
+        }
+        auto iterations = u64{1};
+        auto elapsed = time(body, iterations);
+        while (elapsed < MIN_RUN_TIME && iterations < MAX_ITERATIONS) {
+            iterations *= 2;
+            elapsed = time(body, iterations);
+        }
+        for (auto run = 1u; run < RUNS; ++run) {
+            elapsed = std::min(elapsed, time(body, iterations));
+        }
+        record(name, iterations,
+               static_cast<double>(elapsed.count()) /
+                   static_cast<double>(iterations * ops_per_iteration));
+    }
+
+    const std::vector<Result> &results() const noexcept { return results_; }
+
+    /// returns every result as a JSON document
+    std::string json() const;
+
+  private:
+    static constexpr std::chrono::nanoseconds MIN_RUN_TIME{20'000'000};
+    static constexpr u64 MAX_ITERATIONS = u64{1} << 32;
+    static constexpr u32 RUNS = 5;
+
+    std::string filter_;
+    std::vector<Result> results_;
+
+    template <typename Body>
+    static std::chrono::nanoseconds time(Body &body, u64 iterations) {
+        const auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        return std::chrono::steady_clock::now() - start;
+    }
+
+    void record(const std::string &name, u64 iterations, double ns_per_op);
+};
+
+// benchmark groups, each in its own file
+void core_benchmarks(Bench &bench, std::string_view rom_dir);
+void render_benchmarks(Bench &bench);
@@ -0,0 +1,71 @@
+// Benchmark suite: times instruction handlers, drawing, whole ROMs, screen
+// comparisons and rendering, and writes the results as JSON.
+//
+// usage: chip8_bench [--roms DIR] [--filter TEXT] [--out FILE]
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "spdlog/spdlog.h"
+
+#include "harness.h"
+
+namespace {
+
+struct Options {
+    std::string rom_dir;
+    std::string filter;
+    std::string out;
+};
+
+bool parse_options(int argc, char *argv[], Options &options) {
+    for (auto i = 1; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        if (i + 1 >= argc) {
+            return false;
+        }
+        if (arg == "--roms") {
+            options.rom_dir = argv[++i];
+        } else if (arg == "--filter") {
+            options.filter = argv[++i];
+        } else if (arg == "--out") {
+            options.out = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto options = Options{};
+    if (!parse_options(argc, argv, options)) {
+        std::fprintf(stderr,
+                     "usage: %s [--roms DIR] [--filter TEXT] [--out FILE]\n",
+                     argv[0]);
+        return 1;
+    }
+    spdlog::set_level(spdlog::level::info);
+
+    Bench bench{options.filter};
+    core_benchmarks(bench, options.rom_dir);
+    render_benchmarks(bench);
+
+    const auto json = bench.json();
+    if (options.out.empty()) {
+        std::fputs(json.c_str(), stdout);
+        return 0;
+    }
+    std::ofstream out{options.out};
+    out << json;
+    if (!out) {
+        spdlog::error("Could not write {}", options.out);
+        return 1;
+    }
+    spdlog::info("Wrote {} results to {}", bench.results().size(),
+                 options.out);
+}
@@ -0,0 +1,76 @@
+// Benchmarks of the screen rendering Emu::render does, drawn into an
+// offscreen surface through SDL's software renderer so no window or GPU is
+// needed.
+
+#include <string>
+
+#include "SDL.h"
+#include "spdlog/spdlog.h"
+
+#include "chip8.h"
+#include "common.h"
+#include "harness.h"
+#include "screen_renderer.h"
+
+namespace {
+
+// the emulator's colors
+constexpr ScreenColor BACKGROUND{0x0F, 0x0F, 0xFF};
+constexpr ScreenColor PIXEL{0xFF, 0x00, 0x0F};
+
+void render_at_scale(Bench &bench, int scale) {
+    auto *surface = SDL_CreateRGBSurfaceWithFormat(
+        0, Chip8::SCREEN_WIDTH * scale, Chip8::SCREEN_HEIGHT * scale, 32,
+        SDL_PIXELFORMAT_ARGB8888);
+    if (!surface) {
+        spdlog::error("Offscreen surface could not be created!\nError: {}",
+                      SDL_GetError());
+        return;
+    }
+    auto *renderer = SDL_CreateSoftwareRenderer(surface);
+    if (!renderer) {
+        spdlog::error("Software renderer could not be created!\nError: {}",
+                      SDL_GetError());
+        SDL_FreeSurface(surface);
+        return;
+    }
+
+    {
+        ScreenRenderer<Chip8> screen_renderer{{BACKGROUND, PIXEL}};
+        if (screen_renderer.init(renderer) == 0) {
+            auto checkered = Chip8::Screen{};
+            for (auto row = 0u; row < Chip8::SCREEN_HEIGHT; ++row) {
+                checkered[row] = row % 2 ? 0xAAAAAAAAAAAAAAAAu
+                                         : 0x5555555555555555u;
+            }
+            auto inverted = checkered;
+            for (auto &row : inverted) {
+                row = ~row;
+            }
+
+            const auto prefix = "render/scale" + std::to_string(scale);
+            // every frame differs, so every frame uploads
+            bench.run(prefix + "/changed", 1, [&](u64 iterations) {
+                for (auto i = 0u; i < iterations; ++i) {
+                    screen_renderer.render(i % 2 ? inverted : checkered);
+                }
+            });
+            bench.run(prefix + "/unchanged", 1, [&](u64 iterations) {
+                for (auto i = 0u; i < iterations; ++i) {
+                    screen_renderer.render(checkered);
+                }
+            });
+        }
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+
+} // namespace
+
+void render_benchmarks(Bench &bench) {
+    for (const auto scale : {1, 10, 20}) {
+        render_at_scale(bench, scale);
+    }
+}
@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+
+#include "spdlog/spdlog.h"
+
+#include "chip8.h"
+#include "common.h"
+
+// Executes the input as a stream of big endian opcodes, without fetching,
+// through the dispatch table and through the reference switch of every
+// variant, and checks both end in the same state with the stack within
+// bounds. ASan catches any access outside the core's arrays.
+
+namespace {
+
+[[noreturn]] void fail(std::string_view variant, std::string_view what) {
+    spdlog::critical("{}: {}", variant, what);
+    std::abort();
+}
+
+template <typename Core> void check(std::span<const u8> opcodes) {
+    // kept across inputs, reset before each
+    static Core table;
+    static Core reference;
+    table.reset();
+    reference.reset();
+
+    for (auto i = 0u; i + 1 < opcodes.size(); i += 2) {
+        const auto opcode =
+            static_cast<u16>((opcodes[i] << 8) + opcodes[i + 1]);
+        // the low bits of the opcode stand in for the keypad and the timers
+        const auto keys = static_cast<u16>(1u << (opcode & 0xF));
+        table.set_keys(keys);
+        reference.set_keys(keys);
+        table.execute(opcode);
+        reference.execute_switch(opcode);
+        if (i % 32 == 0) {
+            table.tick_timers();
+            reference.tick_timers();
+        }
+
+        if (table.stack().size() > Core::STACK_SIZE) {
+            fail(Core::VARIANT, "stack pointer past the stack");
+        }
+    }
+    if (!(table.save_state() == reference.save_state())) {
+        fail(Core::VARIANT, "execute and execute_switch disagree");
+    }
+}
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data,
+                                      std::size_t size) {
+    const auto opcodes = std::span{data, size};
+    check<Chip8>(opcodes);
+    check<SuperChip>(opcodes);
+    check<XoChip>(opcodes);
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "common.h"
+
+// Stands in for libFuzzer's main with compilers which have none. Runs every
+// file given, and every file in each directory given, through the target
+// once, which is enough to replay a crash or keep a corpus as a regression
+// test. Flags meant for libFuzzer are ignored.
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data,
+                                      std::size_t size);
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool run_file(const fs::path &path) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        spdlog::error("Could not open {}", path.string());
+        return false;
+    }
+    const std::vector<u8> input{std::istreambuf_iterator<char>{file}, {}};
+    LLVMFuzzerTestOneInput(input.data(), input.size());
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto inputs = 0u;
+    for (auto i = 1; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        if (arg.starts_with("-")) {
+            continue;
+        }
+        auto paths = std::vector<fs::path>{};
+        if (fs::is_directory(arg)) {
+            for (const auto &entry : fs::directory_iterator{arg}) {
+                if (entry.is_regular_file()) {
+                    paths.push_back(entry.path());
+                }
+            }
+        } else {
+            paths.emplace_back(arg);
+        }
+        for (const auto &path : paths) {
+            if (!run_file(path)) {
+                return 1;
+            }
+            ++inputs;
+        }
+    }
+    std::printf("ran %u inputs\n", inputs);
+}
@@ -0,0 +1,93 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string_view>
+
+#include "spdlog/spdlog.h"
+
+#include "chip8.h"
+#include "common.h"
+
+// Runs the input as a ROM on every backend of every variant and checks they
+// agree, that the stack stays within bounds and that a run only stops short
+// at the end of memory. ASan catches any access outside the core's arrays.
+
+namespace {
+
+// cycles per run() call, uneven so budgets end in the middle of blocks
+constexpr std::array<u32, 6> SLICES = {1, 7, 64, 3, 300, 25};
+
+[[noreturn]] void fail(std::string_view variant, std::string_view what) {
+    spdlog::critical("{}: {}", variant, what);
+    std::abort();
+}
+
+/// One instance per backend, kept across inputs and reset before each.
+template <typename Core, std::size_t Count> struct Backends {
+    std::array<Core, Count> cores;
+
+    explicit Backends(std::array<typename Core::Backend, Count> backends) {
+        for (auto i = 0u; i < Count; ++i) {
+            cores[i].set_backend(backends[i]);
+        }
+    }
+
+    void check(std::span<const u8> rom) {
+        const auto image = Core::make_image(rom);
+        for (auto &core : cores) {
+            core.reset();
+            core.share_memory(image);
+        }
+
+        constexpr auto NAME = Core::VARIANT;
+        for (auto round = 0u; round < SLICES.size(); ++round) {
+            const auto slice = SLICES[round];
+            std::array<u32, Count> ran{};
+            for (auto i = 0u; i < Count; ++i) {
+                // a different key each round reaches both sides of key waits
+                // and skips
+                cores[i].set_keys(static_cast<u16>(1u << round));
+                ran[i] = cores[i].run(slice);
+                cores[i].tick_timers();
+
+                if (cores[i].stack().size() > Core::STACK_SIZE) {
+                    fail(NAME, "stack pointer past the stack");
+                }
+                if (ran[i] < slice && cores[i].pc() < Core::MEMORY_SIZE - 1) {
+                    fail(NAME, "run stopped short inside memory");
+                }
+                if (ran[i] != ran[0]) {
+                    fail(NAME, "backends ran different cycle counts");
+                }
+            }
+        }
+        const auto state = cores[0].save_state();
+        for (auto i = 1u; i < Count; ++i) {
+            if (!(cores[i].save_state() == state)) {
+                fail(NAME, "backends ended in different states");
+            }
+        }
+    }
+};
+
+} // namespace
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t *data,
+                                      std::size_t size) {
+    // the jit only translates CHIP-8
+    static Backends<Chip8, 3> chip8{{Chip8::Backend::interpreter,
+                                     Chip8::Backend::block_cache,
+                                     Chip8::Backend::jit}};
+    static Backends<SuperChip, 2> superchip{
+        {SuperChip::Backend::interpreter, SuperChip::Backend::block_cache}};
+    static Backends<XoChip, 2> xochip{
+        {XoChip::Backend::interpreter, XoChip::Backend::block_cache}};
+
+    const auto rom = std::span{data, size};
+    chip8.check(rom);
+    superchip.check(rom);
+    xochip.check(rom);
+    return 0;
+}
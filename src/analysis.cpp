@@ -0,0 +1,695 @@
+#include "analysis.h"
+
+#include <algorithm>
+#include <bitset>
+#include <map>
+#include <optional>
+#include <tuple>
+
+#include "spdlog/fmt/fmt.h"
+
+#include "chip8.h"
+
+namespace analysis {
+
+namespace {
+
+// the analysis is CHIP-8 only, a larger ROM is cut off at what fits in its
+// memory
+constexpr u32 ADDRESS_SPACE = Chip8::MEMORY_SIZE;
+constexpr std::size_t MAX_ROM_SIZE = Chip8::MAX_ROM_SIZE;
+// BNNN adds V0, so a jump table holds at most this many entries
+constexpr u32 MAX_TABLE_ENTRIES = 128;
+// instructions in a row, the last a jump, call or return, which make an
+// unreached run of bytes look like code rather than data
+constexpr u32 MIN_UNREACHABLE_RUN = 3;
+
+/// The ROM as loaded at ROM_START.
+class Image {
+  public:
+    explicit Image(std::span<const u8> rom) : rom_{rom} {}
+
+    /// true if @param address is in the ROM
+    bool contains(u32 address) const noexcept {
+        return address >= Chip8::ROM_START &&
+               address < Chip8::ROM_START + rom_.size();
+    }
+    /// true if both bytes of an instruction at @param address are in the ROM
+    bool holds(u32 address) const noexcept {
+        return contains(address) && contains(address + 1);
+    }
+    u16 opcode(u32 address) const noexcept {
+        const auto offset = address - Chip8::ROM_START;
+        return static_cast<u16>((rom_[offset] << 8) + rom_[offset + 1]);
+    }
+    u32 end() const noexcept {
+        return Chip8::ROM_START + static_cast<u32>(rom_.size());
+    }
+
+  private:
+    std::span<const u8> rom_;
+};
+
+bool bad(Op op) noexcept { return op == Op::_0NNN || op == Op::unknown; }
+
+// true if @param opcode leaves V0 holding something other than before
+bool writes_v0(u16 opcode) noexcept {
+    const auto X = nibble(nib::second, opcode);
+    switch (decode(opcode)) {
+    case Op::_6XNN:
+    case Op::_7XNN:
+    case Op::_8XY0:
+    case Op::_8XY1:
+    case Op::_8XY2:
+    case Op::_8XY3:
+    case Op::_8XY4:
+    case Op::_8XY5:
+    case Op::_8XY6:
+    case Op::_8XY7:
+    case Op::_8XYE:
+    case Op::_CXNN:
+    case Op::_FX07:
+    case Op::_FX0A:
+        return X == 0x0;
+    case Op::_FX65:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// Follows the code of a ROM from each routine entry.
+class Explorer {
+  public:
+    explicit Explorer(const Image &image, Analysis &analysis)
+        : image_{image}, analysis_{analysis} {}
+
+    void explore() {
+        add_routine(Chip8::ROM_START);
+        // routines are appended while exploring
+        for (auto i = 0u; i < routines_.size(); ++i) {
+            explore_routine(i);
+        }
+    }
+
+    const std::bitset<ADDRESS_SPACE> &visited() const noexcept {
+        return visited_;
+    }
+    const std::bitset<ADDRESS_SPACE> &leaders() const noexcept {
+        return leader_;
+    }
+    std::vector<Routine> &routines() noexcept { return routines_; }
+    std::map<u16, JumpTable> &jump_tables() noexcept { return tables_; }
+
+  private:
+    const Image &image_;
+    Analysis &analysis_;
+    // instructions found and the addresses a block starts at
+    std::bitset<ADDRESS_SPACE> visited_;
+    std::bitset<ADDRESS_SPACE> leader_;
+    std::vector<Routine> routines_;
+    std::map<u16, u32> routine_at_;
+    std::map<u16, JumpTable> tables_;
+
+    void issue(Issue::Kind kind, u16 address) {
+        analysis_.issues.push_back({kind, address});
+    }
+
+    void add_routine(u16 entry) {
+        if (routine_at_.contains(entry)) {
+            return;
+        }
+        routine_at_[entry] = static_cast<u32>(routines_.size());
+        routines_.push_back({.entry = entry, .calls = {}});
+        leader_.set(entry);
+    }
+
+    // queues @param target as the start of a block, reached from the
+    // instruction at @param from
+    void target(u16 from, u32 target, std::vector<u16> &pending) {
+        if (!image_.holds(target)) {
+            issue(Issue::Kind::leaves_rom, from);
+            return;
+        }
+        leader_.set(target);
+        pending.push_back(static_cast<u16>(target));
+    }
+
+    void explore_routine(u32 index) {
+        const auto entry = routines_[index].entry;
+        std::bitset<ADDRESS_SPACE> seen;
+        std::vector<u16> pending{entry};
+        std::vector<u16> calls;
+        if (!image_.holds(entry)) {
+            return;
+        }
+        while (!pending.empty()) {
+            auto address = pending.back();
+            pending.pop_back();
+            // V0 while it holds a constant, for BNNN
+            std::optional<u8> v0;
+            while (!seen.test(address)) {
+                seen.set(address);
+                visited_.set(address);
+                const auto opcode = image_.opcode(address);
+                const auto op = decode(opcode);
+                const u32 next = address + 2;
+                if (bad(op)) {
+                    issue(Issue::Kind::bad_opcode, address);
+                }
+                if (ends_block(op)) {
+                    branch(index, address, opcode, v0, pending, calls);
+                    break;
+                }
+                if (writes_v0(opcode)) {
+                    v0.reset();
+                    if (op == Op::_6XNN) {
+                        v0 = static_cast<u8>(opcode & 0x00FF);
+                    }
+                }
+                if (!image_.holds(next)) {
+                    issue(Issue::Kind::leaves_rom, address);
+                    break;
+                }
+                address = static_cast<u16>(next);
+            }
+        }
+        std::ranges::sort(calls);
+        const auto [first, last] = std::ranges::unique(calls);
+        calls.erase(first, last);
+        routines_[index].calls = std::move(calls);
+    }
+
+    // follows the instruction @param opcode at @param address which ends a
+    // block
+    void branch(u32 routine, u16 address, u16 opcode, std::optional<u8> v0,
+                std::vector<u16> &pending, std::vector<u16> &calls) {
+        const u32 next = address + 2;
+        const u16 NNN = opcode & 0x0FFF;
+        switch (decode(opcode)) {
+        case Op::_00EE:
+            if (routine == 0) {
+                issue(Issue::Kind::stack_underflow, address);
+            }
+            break;
+        case Op::_1NNN:
+            target(address, NNN, pending);
+            break;
+        case Op::_2NNN:
+            if (image_.holds(NNN)) {
+                add_routine(NNN);
+                calls.push_back(NNN);
+            } else {
+                issue(Issue::Kind::leaves_rom, address);
+            }
+            target(address, next, pending);
+            break;
+        case Op::_3XNN:
+        case Op::_4XNN:
+        case Op::_5XY0:
+        case Op::_9XY0:
+        case Op::_EX9E:
+        case Op::_EXA1:
+            target(address, next, pending);
+            target(address, next + 2, pending);
+            break;
+        case Op::_FX0A:
+            // waiting repeats the instruction
+            target(address, address, pending);
+            target(address, next, pending);
+            break;
+        case Op::_BNNN: {
+            auto &table = tables_[address];
+            table = jump_table(address, NNN, v0);
+            if (table.targets.empty()) {
+                issue(Issue::Kind::unresolved_jump, address);
+            }
+            for (const auto entry : table.targets) {
+                target(address, entry, pending);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    // the targets of BNNN at @param address: NNN + V0 if V0 is known,
+    // otherwise the run of jumps at NNN the table is taken to be
+    JumpTable jump_table(u16 address, u16 base, std::optional<u8> v0) const {
+        auto table =
+            JumpTable{.address = address, .base = base, .targets = {}};
+        if (v0) {
+            table.targets.push_back(static_cast<u16>(base + *v0));
+            return table;
+        }
+        for (auto entry = 0u; entry < MAX_TABLE_ENTRIES; ++entry) {
+            const auto at = base + 2 * entry;
+            if (!image_.holds(at) || decode(image_.opcode(at)) != Op::_1NNN) {
+                break;
+            }
+            table.targets.push_back(static_cast<u16>(at));
+        }
+        return table;
+    }
+};
+
+// cuts the instructions found into blocks at every leader
+std::vector<Block> make_blocks(const Image &image, const Explorer &explorer,
+                               const std::map<u16, JumpTable> &tables) {
+    std::vector<Block> blocks;
+    for (auto start = 0u; start < ADDRESS_SPACE; ++start) {
+        if (!explorer.leaders().test(start) ||
+            !explorer.visited().test(start)) {
+            continue;
+        }
+        auto block = Block{.start = static_cast<u16>(start),
+                           .end = static_cast<u16>(start),
+                           .successors = {}};
+        auto last = block.start;
+        do {
+            last = block.end;
+            block.end += 2;
+            ++block.length;
+            if (ends_block(decode(image.opcode(last)))) {
+                break;
+            }
+        } while (image.holds(block.end) && !explorer.leaders().test(block.end));
+
+        const auto opcode = image.opcode(last);
+        const u32 next = block.end;
+        const u16 NNN = opcode & 0x0FFF;
+        auto &successors = block.successors;
+        switch (decode(opcode)) {
+        case Op::_00EE:
+            break;
+        case Op::_1NNN:
+            successors = {NNN};
+            break;
+        case Op::_3XNN:
+        case Op::_4XNN:
+        case Op::_5XY0:
+        case Op::_9XY0:
+        case Op::_EX9E:
+        case Op::_EXA1:
+            successors = {static_cast<u16>(next), static_cast<u16>(next + 2)};
+            break;
+        case Op::_FX0A:
+            successors = {last, static_cast<u16>(next)};
+            break;
+        case Op::_BNNN:
+            successors = tables.at(last).targets;
+            break;
+        default:
+            // falls through, calls included
+            successors = {static_cast<u16>(next)};
+            break;
+        }
+        std::erase_if(successors, [&image](u16 address) {
+            return !image.holds(address);
+        });
+        blocks.push_back(std::move(block));
+    }
+    return blocks;
+}
+
+// marks the bytes read and written through I as data and flags stores into
+// code. I is only known after an ANNN in the same block
+void find_data(const Image &image, Analysis &analysis) {
+    auto &bytes = analysis.bytes;
+    const auto touch = [&](u16 from, u32 first, u32 count, bool store) {
+        for (auto address = first; address < first + count; ++address) {
+            if (!image.contains(address)) {
+                continue;
+            }
+            if (bytes[address] == Byte::code) {
+                if (store) {
+                    analysis.issues.push_back(
+                        {Issue::Kind::write_into_code, from});
+                    return;
+                }
+                continue;
+            }
+            bytes[address] = Byte::data;
+        }
+    };
+
+    for (const auto &block : analysis.blocks) {
+        // a u16 and a flag rather than an optional, which GCC warns may be
+        // read uninitialized once the switch is optimized
+        u16 I = 0;
+        auto I_known = false;
+        for (auto address = block.start; address < block.end; address += 2) {
+            const auto opcode = image.opcode(address);
+            const auto X = nibble(nib::second, opcode);
+            switch (decode(opcode)) {
+            case Op::_ANNN:
+                I = opcode & 0x0FFF;
+                I_known = true;
+                break;
+            case Op::_FX1E:
+            case Op::_FX29:
+                I_known = false;
+                break;
+            case Op::_DXYN:
+                if (I_known) {
+                    touch(address, I, nibble(nib::fourth, opcode), false);
+                }
+                break;
+            case Op::_FX33:
+                if (I_known) {
+                    touch(address, I, 3, true);
+                }
+                break;
+            case Op::_FX55:
+                if (I_known) {
+                    touch(address, I, X + 1u, true);
+                }
+                break;
+            case Op::_FX65:
+                if (I_known) {
+                    touch(address, I, X + 1u, false);
+                }
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+// flags runs of unclassified bytes which decode as instructions ending in a
+// jump, call or return
+void find_unreachable(const Image &image, Analysis &analysis) {
+    auto run = 0u;
+    for (auto address = Chip8::ROM_START; image.holds(address);) {
+        if (analysis.bytes[address] != Byte::unknown ||
+            analysis.bytes[address + 1] != Byte::unknown) {
+            run = 0;
+            ++address;
+            continue;
+        }
+        const auto opcode = image.opcode(address);
+        const auto op = decode(opcode);
+        if (bad(op)) {
+            run = 0;
+            address += 2;
+            continue;
+        }
+        ++run;
+        const auto leaves = op == Op::_00EE ||
+                            ((op == Op::_1NNN || op == Op::_2NNN) &&
+                             image.holds(opcode & 0x0FFF));
+        if (leaves && run >= MIN_UNREACHABLE_RUN) {
+            analysis.issues.push_back(
+                {Issue::Kind::unreachable_code,
+                 static_cast<u16>(address - 2 * (run - 1))});
+            run = 0;
+        } else if (leaves) {
+            run = 0;
+        }
+        address += 2;
+    }
+}
+
+// fills in the depth of every routine and flags recursion and calls nested
+// deeper than the stack
+void find_depths(Analysis &analysis) {
+    auto &routines = analysis.routines;
+    std::map<u16, u32> index;
+    for (auto i = 0u; i < routines.size(); ++i) {
+        index[routines[i].entry] = i;
+    }
+
+    // depth first from the entry point, a call back to a routine on the
+    // path closes a cycle
+    enum class Mark : u8 { none, on_path, done };
+    std::vector<Mark> marks(routines.size(), Mark::none);
+    std::vector<u32> order;
+    std::vector<u32> path;
+    const auto visit = [&](auto &self, u32 routine) -> void {
+        marks[routine] = Mark::on_path;
+        path.push_back(routine);
+        for (const auto callee : routines[routine].calls) {
+            const auto next = index.at(callee);
+            if (marks[next] == Mark::on_path) {
+                const auto cycle = std::ranges::find(path, next);
+                for (auto it = cycle; it != path.end(); ++it) {
+                    routines[*it].recursive = true;
+                }
+                analysis.issues.push_back(
+                    {Issue::Kind::recursion, routines[next].entry});
+            } else if (marks[next] == Mark::none) {
+                self(self, next);
+            }
+        }
+        path.pop_back();
+        marks[routine] = Mark::done;
+        order.push_back(routine);
+    };
+    if (!routines.empty()) {
+        visit(visit, 0);
+    }
+
+    // longest paths in reverse post order, skipping the calls closing a
+    // cycle
+    std::vector<u32> position(routines.size());
+    for (auto i = 0u; i < order.size(); ++i) {
+        position[order[i]] = i;
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const auto &caller = routines[*it];
+        for (const auto callee : caller.calls) {
+            const auto next = index.at(callee);
+            if (position[next] < position[*it]) {
+                routines[next].depth =
+                    std::max(routines[next].depth, caller.depth + 1);
+            }
+        }
+    }
+    for (const auto &routine : routines) {
+        if (routine.depth == Chip8::STACK_SIZE + 1u) {
+            analysis.issues.push_back(
+                {Issue::Kind::stack_overflow, routine.entry});
+        }
+    }
+}
+
+} // namespace
+
+std::string_view kind_name(Issue::Kind kind) noexcept {
+    switch (kind) {
+    case Issue::Kind::bad_opcode:
+        return "bad_opcode";
+    case Issue::Kind::stack_underflow:
+        return "stack_underflow";
+    case Issue::Kind::stack_overflow:
+        return "stack_overflow";
+    case Issue::Kind::write_into_code:
+        return "write_into_code";
+    case Issue::Kind::unreachable_code:
+        return "unreachable_code";
+    case Issue::Kind::recursion:
+        return "recursion";
+    case Issue::Kind::unresolved_jump:
+        return "unresolved_jump";
+    case Issue::Kind::leaves_rom:
+        return "leaves_rom";
+    }
+    return "unknown";
+}
+
+bool Analysis::rejected() const noexcept {
+    return std::ranges::any_of(
+        issues, [](const Issue &issue) { return issue.error(); });
+}
+
+u32 Analysis::max_depth() const noexcept {
+    auto depth = 0u;
+    for (const auto &routine : routines) {
+        if (routine.recursive) {
+            return UNBOUNDED;
+        }
+        depth = std::max(depth, routine.depth);
+    }
+    return depth;
+}
+
+Analysis analyze(std::span<const u8> rom) {
+    auto analysis = Analysis{};
+    analysis.rom.assign(rom.begin(),
+                        rom.begin() + std::min(rom.size(), MAX_ROM_SIZE));
+    const Image image{analysis.rom};
+
+    Explorer explorer{image, analysis};
+    explorer.explore();
+    for (auto address = 0u; address < ADDRESS_SPACE; ++address) {
+        if (explorer.visited().test(address)) {
+            analysis.bytes[address] = Byte::code;
+            analysis.bytes[address + 1] = Byte::code;
+        }
+    }
+    analysis.blocks = make_blocks(image, explorer, explorer.jump_tables());
+    analysis.routines = std::move(explorer.routines());
+    for (auto &[address, table] : explorer.jump_tables()) {
+        analysis.jump_tables.push_back(std::move(table));
+    }
+
+    find_data(image, analysis);
+    find_unreachable(image, analysis);
+    find_depths(analysis);
+
+    auto &issues = analysis.issues;
+    std::ranges::sort(issues, [](const Issue &a, const Issue &b) {
+        return std::tie(a.address, a.kind) < std::tie(b.address, b.kind);
+    });
+    const auto [first, last] = std::ranges::unique(issues);
+    issues.erase(first, last);
+    return analysis;
+}
+
+std::string disassemble(u16 opcode) {
+    const auto X = nibble(nib::second, opcode);
+    const auto Y = nibble(nib::third, opcode);
+    const auto N = nibble(nib::fourth, opcode);
+    const auto NN = opcode & 0x00FF;
+    const auto NNN = opcode & 0x0FFF;
+    switch (decode(opcode)) {
+    case Op::_0NNN:
+        return fmt::format("SYS 0x{:03X}", NNN);
+    case Op::_00E0:
+        return "CLS";
+    case Op::_00EE:
+        return "RET";
+    case Op::_1NNN:
+        return fmt::format("JP 0x{:03X}", NNN);
+    case Op::_2NNN:
+        return fmt::format("CALL 0x{:03X}", NNN);
+    case Op::_3XNN:
+        return fmt::format("SE V{:X}, 0x{:02X}", X, NN);
+    case Op::_4XNN:
+        return fmt::format("SNE V{:X}, 0x{:02X}", X, NN);
+    case Op::_5XY0:
+        return fmt::format("SE V{:X}, V{:X}", X, Y);
+    case Op::_6XNN:
+        return fmt::format("LD V{:X}, 0x{:02X}", X, NN);
+    case Op::_7XNN:
+        return fmt::format("ADD V{:X}, 0x{:02X}", X, NN);
+    case Op::_8XY0:
+        return fmt::format("LD V{:X}, V{:X}", X, Y);
+    case Op::_8XY1:
+        return fmt::format("OR V{:X}, V{:X}", X, Y);
+    case Op::_8XY2:
+        return fmt::format("AND V{:X}, V{:X}", X, Y);
+    case Op::_8XY3:
+        return fmt::format("XOR V{:X}, V{:X}", X, Y);
+    case Op::_8XY4:
+        return fmt::format("ADD V{:X}, V{:X}", X, Y);
+    case Op::_8XY5:
+        return fmt::format("SUB V{:X}, V{:X}", X, Y);
+    case Op::_8XY6:
+        return fmt::format("SHR V{:X}, V{:X}", X, Y);
+    case Op::_8XY7:
+        return fmt::format("SUBN V{:X}, V{:X}", X, Y);
+    case Op::_8XYE:
+        return fmt::format("SHL V{:X}, V{:X}", X, Y);
+    case Op::_9XY0:
+        return fmt::format("SNE V{:X}, V{:X}", X, Y);
+    case Op::_ANNN:
+        return fmt::format("LD I, 0x{:03X}", NNN);
+    case Op::_BNNN:
+        return fmt::format("JP V0, 0x{:03X}", NNN);
+    case Op::_CXNN:
+        return fmt::format("RND V{:X}, 0x{:02X}", X, NN);
+    case Op::_DXYN:
+        return fmt::format("DRW V{:X}, V{:X}, {}", X, Y, N);
+    case Op::_EX9E:
+        return fmt::format("SKP V{:X}", X);
+    case Op::_EXA1:
+        return fmt::format("SKNP V{:X}", X);
+    case Op::_FX07:
+        return fmt::format("LD V{:X}, DT", X);
+    case Op::_FX0A:
+        return fmt::format("LD V{:X}, K", X);
+    case Op::_FX15:
+        return fmt::format("LD DT, V{:X}", X);
+    case Op::_FX18:
+        return fmt::format("LD ST, V{:X}", X);
+    case Op::_FX1E:
+        return fmt::format("ADD I, V{:X}", X);
+    case Op::_FX29:
+        return fmt::format("LD F, V{:X}", X);
+    case Op::_FX33:
+        return fmt::format("LD B, V{:X}", X);
+    case Op::_FX55:
+        return fmt::format("LD [I], V{:X}", X);
+    case Op::_FX65:
+        return fmt::format("LD V{:X}, [I]", X);
+    default:
+        return fmt::format("DW 0x{:04X}", opcode);
+    }
+}
+
+void write_listing(const Analysis &analysis, std::ostream &out) {
+    const Image image{analysis.rom};
+    const auto depth = analysis.max_depth();
+    out << fmt::format("; {} bytes, {} blocks, {} routines, max stack depth "
+                       "{}\n",
+                       analysis.rom.size(), analysis.blocks.size(),
+                       analysis.routines.size(),
+                       depth == UNBOUNDED ? "unbounded"
+                                          : std::to_string(depth));
+    for (const auto &table : analysis.jump_tables) {
+        out << fmt::format("; jump table at {:03X}:", table.address);
+        for (const auto target : table.targets) {
+            out << fmt::format(" {:03X}", target);
+        }
+        out << '\n';
+    }
+    for (const auto &issue : analysis.issues) {
+        out << fmt::format("; {} {} at {:03X}\n",
+                           issue.error() ? "error" : "warning",
+                           kind_name(issue.kind), issue.address);
+    }
+
+    std::map<u16, const Routine *> routines;
+    for (const auto &routine : analysis.routines) {
+        routines[routine.entry] = &routine;
+    }
+    auto block = analysis.blocks.begin();
+    for (auto address = u32{Chip8::ROM_START}; address < image.end();) {
+        while (block != analysis.blocks.end() && block->start < address) {
+            ++block;
+        }
+        if (block != analysis.blocks.end() && block->start == address) {
+            out << '\n';
+            if (const auto routine = routines.find(block->start);
+                routine != routines.end()) {
+                out << fmt::format("; routine, depth {}{}\n",
+                                   routine->second->depth,
+                                   routine->second->recursive ? ", recursive"
+                                                              : "");
+            }
+            for (; address < block->end; address += 2) {
+                const auto opcode = image.opcode(address);
+                out << fmt::format("{:03X}  {:04X}  {}\n", address, opcode,
+                                   disassemble(opcode));
+            }
+            continue;
+        }
+        const auto byte = analysis.rom[address - Chip8::ROM_START];
+        if (analysis.bytes[address] == Byte::data) {
+            std::string bits;
+            for (auto bit = 7; bit >= 0; --bit) {
+                bits += (byte >> bit) & 0x1 ? '#' : '.';
+            }
+            out << fmt::format("{:03X}  {:02X}    {}\n", address, byte, bits);
+        } else {
+            out << fmt::format("{:03X}  {:02X}    DB 0x{:02X}\n", address, byte,
+                               byte);
+        }
+        ++address;
+    }
+}
+
+} // namespace analysis
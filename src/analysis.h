@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <ostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.h"
+#include "decode.h"
+
+// Static analysis of a CHIP-8 ROM, decoded the same way Chip8::execute
+// decodes it. Only CHIP-8 is analyzed, SUPER-CHIP and XO-CHIP opcodes are
+// unknown to it and a ROM is cut off at Chip8::MAX_ROM_SIZE.
+//
+// Code is found by following every jump, call, return address and both
+// sides of every skip from ROM_START, and the entries of jump tables read by
+// BNNN. Bytes I points at when a sprite is drawn or registers are loaded or
+// stored are data. The code is cut into basic blocks and grouped into
+// routines, the entry point and every call target, which make up the call
+// graph. The result drives chip8_recompile and lets chip8_analyze reject
+// ROMs with errors before they are run.
+
+namespace analysis {
+
+/// the stack depth of a ROM with recursion
+inline constexpr u32 UNBOUNDED = ~0u;
+
+/// what a byte of memory was found to hold
+enum class Byte : u8 {
+    // not reached as code nor read as data
+    unknown,
+    code,
+    data,
+};
+
+/// A straight line run of instructions, ending at the first one which can
+/// move the pc elsewhere or where another block starts.
+struct Block {
+    u16 start = 0x0;
+    // one past the last byte of the block
+    u16 end = 0x0;
+    // instructions in the block
+    u32 length = 0;
+    // where the pc can go after the block, calls continue at their return
+    // address. Empty after a return or an unresolved BNNN
+    std::vector<u16> successors;
+};
+
+/// The code reachable from an entry point without following calls.
+struct Routine {
+    u16 entry = 0x0;
+    // entries of the routines it calls, sorted
+    std::vector<u16> calls;
+    // return addresses on the stack when it is entered on the deepest call
+    // path from the entry point, not counting trips around a recursion
+    u32 depth = 0;
+    // part of a cycle in the call graph
+    bool recursive = false;
+};
+
+/// A BNNN and the addresses it can jump to.
+struct JumpTable {
+    // the BNNN
+    u16 address = 0x0;
+    u16 base = 0x0;
+    // sorted, empty if none could be found
+    std::vector<u16> targets;
+};
+
+/// Something wrong with a ROM.
+struct Issue {
+    enum class Kind : u8 {
+        // errors, the ROM is rejected
+        // a reachable opcode which is not an instruction
+        bad_opcode,
+        // a return with an empty stack
+        stack_underflow,
+        // more than Chip8::STACK_SIZE nested calls
+        stack_overflow,
+        // a store into reachable code
+        write_into_code,
+        // warnings
+        // a run of instructions which is never reached
+        unreachable_code,
+        // a call graph cycle, the stack depth is unbounded
+        recursion,
+        // a BNNN whose targets could not be found
+        unresolved_jump,
+        // a jump, call or skip out of the ROM
+        leaves_rom,
+    };
+
+    Kind kind;
+    u16 address = 0x0;
+
+    bool error() const noexcept { return kind < Kind::unreachable_code; }
+    bool operator==(const Issue &) const = default;
+};
+
+/// the name of @param kind, e.g. "stack_underflow"
+std::string_view kind_name(Issue::Kind kind) noexcept;
+
+/// The analysis of one ROM.
+struct Analysis {
+    // the ROM as loaded at ROM_START
+    std::vector<u8> rom;
+    // what every byte of memory holds
+    std::array<Byte, 4096> bytes = {Byte::unknown};
+    // by start address
+    std::vector<Block> blocks;
+    // by entry, the entry point first
+    std::vector<Routine> routines;
+    // by address
+    std::vector<JumpTable> jump_tables;
+    // by address
+    std::vector<Issue> issues;
+
+    /// true if any issue is an error
+    bool rejected() const noexcept;
+    /// the deepest the stack gets from the entry point, UNBOUNDED with
+    /// recursion
+    u32 max_depth() const noexcept;
+};
+
+/// analyzes @param rom, anything past Chip8::MAX_ROM_SIZE is cut off
+Analysis analyze(std::span<const u8> rom);
+
+/// returns @param opcode in assembly, e.g. "LD V1, 0x12"
+std::string disassemble(u16 opcode);
+
+/// writes an annotated listing of the ROM in @param analysis to @param out,
+/// code as assembly and data as bits
+void write_listing(const Analysis &analysis, std::ostream &out);
+
+} // namespace analysis
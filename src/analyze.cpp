@@ -0,0 +1,158 @@
+// Static ROM analyzer: analyzes every .ch8 file given, or in each directory
+// given, in parallel and prints one result line per ROM and one line per
+// issue found. Exits with 1 if any ROM has an error, so ROMs can be rejected
+// before they are run.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "analysis.h"
+#include "chip8.h"
+#include "common.h"
+#include "rom.h"
+#include "thread_pool.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct Options {
+    std::vector<fs::path> roms;
+    u32 threads = std::thread::hardware_concurrency();
+    // writes a listing of every rom here
+    fs::path listing_dir;
+};
+
+struct Result {
+    fs::path path;
+    analysis::Analysis analysis;
+    bool loaded = false;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s <rom.ch8 | rom_dir>... [--threads N] "
+                 "[--listing DIR]\n",
+                 program);
+}
+
+bool parse_options(int argc, char *argv[], Options &options) {
+    for (auto i = 1; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<u32>(std::stoul(argv[++i]));
+            continue;
+        }
+        if (arg == "--listing" && i + 1 < argc) {
+            options.listing_dir = argv[++i];
+            continue;
+        }
+        if (arg.starts_with("-")) {
+            return false;
+        }
+        if (!fs::is_directory(arg)) {
+            options.roms.emplace_back(arg);
+            continue;
+        }
+        for (const auto &entry : fs::directory_iterator{arg}) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ch8") {
+                options.roms.push_back(entry.path());
+            }
+        }
+    }
+    return !options.roms.empty();
+}
+
+Result analyze_rom(const fs::path &path, const Options &options) {
+    auto result = Result{};
+    result.path = path;
+    // the analysis is CHIP-8 only
+    const auto rom = MappedRom::open(path, Chip8::MAX_ROM_SIZE);
+    if (rom.empty()) {
+        return result;
+    }
+    result.analysis = analysis::analyze(rom.bytes());
+    result.loaded = true;
+
+    if (!options.listing_dir.empty()) {
+        auto listing_path = options.listing_dir / path.filename();
+        listing_path.replace_extension(".lst");
+        std::ofstream listing{listing_path};
+        analysis::write_listing(result.analysis, listing);
+        if (!listing) {
+            spdlog::error("Could not write {}", listing_path.string());
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto options = Options{};
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    std::ranges::sort(options.roms);
+
+    std::vector<Result> results(options.roms.size());
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool{options.threads};
+        for (auto i = 0u; i < options.roms.size(); ++i) {
+            pool.submit([&results, &options, i] {
+                results[i] = analyze_rom(options.roms[i], options);
+            });
+        }
+        pool.wait();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    auto rejected = 0u;
+    std::printf("rom\tblocks\troutines\tmax_depth\terrors\twarnings\n");
+    for (const auto &result : results) {
+        if (!result.loaded) {
+            std::printf("%s\tFAILED\n", result.path.c_str());
+            ++rejected;
+            continue;
+        }
+        const auto &analysis = result.analysis;
+        const auto errors = std::ranges::count_if(
+            analysis.issues,
+            [](const analysis::Issue &issue) { return issue.error(); });
+        const auto depth = analysis.max_depth();
+        std::printf("%s\t%zu\t%zu\t%s\t%td\t%td\n", result.path.c_str(),
+                    analysis.blocks.size(), analysis.routines.size(),
+                    depth == analysis::UNBOUNDED
+                        ? "unbounded"
+                        : std::to_string(depth).c_str(),
+                    errors,
+                    static_cast<std::ptrdiff_t>(analysis.issues.size()) -
+                        errors);
+        for (const auto &issue : analysis.issues) {
+            std::printf("%s\t%s\t%s\t0x%03X\n", result.path.c_str(),
+                        issue.error() ? "error" : "warning",
+                        analysis::kind_name(issue.kind).data(),
+                        issue.address);
+        }
+        if (analysis.rejected()) {
+            ++rejected;
+        }
+    }
+
+    spdlog::info(
+        "Analyzed {} roms in {} ms, {} rejected", results.size(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(),
+        rejected);
+    return rejected > 0 ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+#include "aot.h"
+
+#include <algorithm>
+
+Aot::Aot(const AotProgram &program)
+    : program_{program}, block_at_(ADDRESS_SPACE, 0) {}
+
+void Aot::check(const Chip8 &chip8) noexcept {
+    const auto &memory = chip8.memory();
+    std::ranges::fill(block_at_, 0);
+    code_.reset();
+    for (auto index = 0u; index < program_.blocks.size(); ++index) {
+        const auto &block = program_.blocks[index];
+        auto intact = true;
+        for (auto address = block.start; intact && address < block.end;
+             ++address) {
+            intact = memory[address] ==
+                     program_.rom[address - Chip8::ROM_START];
+        }
+        if (!intact) {
+            CHIP8_TRACE(decode, "Block {:x}-{:x} was written over",
+                        block.start, block.end);
+            continue;
+        }
+        block_at_[block.start] = static_cast<u16>(index + 1);
+        for (auto address = block.start; address < block.end; ++address) {
+            code_.set(address);
+        }
+    }
+    checked_ = true;
+}
+
+u32 Aot::run(Chip8 &chip8, u32 cycles) noexcept {
+    current_ = &chip8;
+    auto executed = 0u;
+
+    while (executed < cycles) {
+        if (!checked_) {
+            check(chip8);
+        }
+        const auto start = chip8.state_.pc;
+        if (start >= ADDRESS_SPACE - 1) {
+            break;
+        }
+        // blocks start at jump targets, where idle loops are entered
+        if (const auto skipped = chip8.skip_idle(cycles - executed);
+            skipped > 0) {
+            executed += skipped;
+            continue;
+        }
+        const auto index = block_at_[start];
+        // a block runs whole, so a budget ending inside one is interpreted
+        if (index == 0 ||
+            program_.blocks[index - 1].length > cycles - executed) {
+            chip8.cycle();
+            ++executed;
+            continue;
+        }
+        executed += program_.blocks[index - 1].run(chip8.state_, *this);
+    }
+    return executed;
+}
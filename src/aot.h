@@ -0,0 +1,91 @@
+#pragma once
+
+#include <bitset>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "chip8.h"
+#include "common.h"
+
+class Aot;
+
+/// One basic block of a ROM translated ahead of time by chip8_recompile.
+struct AotBlock {
+    // runs the block on the machine, returns the instructions executed
+    using Fn = u32 (*)(Chip8::Machine &, Aot &) noexcept;
+
+    u16 start = 0x0;
+    // one past the last byte of the block
+    u16 end = 0x0;
+    // instructions in the block
+    u32 length = 0;
+    Fn run = nullptr;
+};
+
+/// A ROM translated ahead of time into C++, one function per basic block.
+/// chip8_recompile writes a translation unit defining one of these, see
+/// recompiler.h.
+struct AotProgram {
+    std::string_view name;
+    // the ROM translated, loaded at Chip8::ROM_START
+    std::span<const u8> rom;
+    std::span<const AotBlock> blocks;
+};
+
+/// Runs a CHIP-8 with the blocks of an AotProgram.
+///
+/// A block runs wherever the pc is on its start and its bytes in memory are
+/// still the ones it was translated from, everything else is interpreted.
+/// That covers the targets of BNNN, which the translator can not follow, and
+/// blocks the ROM has written over: a store into a running block ends it and
+/// the blocks are checked against memory again before the next one runs.
+class Aot {
+  public:
+    explicit Aot(const AotProgram &program);
+
+    Aot(const Aot &) = delete;
+    Aot &operator=(const Aot &) = delete;
+
+    const AotProgram &program() const noexcept { return program_; }
+
+    /// executes up to @param cycles instructions of @param chip8, returns
+    /// how many ran. Stops early if the pc runs off the end of memory
+    u32 run(Chip8 &chip8, u32 cycles) noexcept;
+
+    /// true if @param address is part of a block which can run
+    bool covers(u16 address) const noexcept { return code_.test(address); }
+    /// checks every block against memory again before the next one runs
+    void flush() noexcept {
+        checked_ = false;
+        ++generation_;
+    }
+
+    /// called by translated blocks for the instructions they leave to the
+    /// interpreter, with the pc already past @param opcode. Returns true if
+    /// it stored into a block, which then has to return
+    bool execute(u16 opcode) noexcept {
+        const auto generation = generation_;
+        current_->execute(opcode);
+        return generation_ != generation;
+    }
+
+  private:
+    static constexpr u32 ADDRESS_SPACE = 4096;
+
+    const AotProgram &program_;
+    // 1 + index into the program's blocks of the block starting at an
+    // address, 0 if there is none or its bytes were written over
+    std::vector<u16> block_at_;
+    // addresses covered by a block which can run
+    std::bitset<ADDRESS_SPACE> code_;
+    bool checked_ = false;
+    // bumped on every flush so a running block can notice
+    u32 generation_ = 0;
+    // the machine the running block belongs to
+    Chip8 *current_ = nullptr;
+
+    // finds the blocks whose bytes in the memory of @param chip8 are still
+    // the ones they were translated from
+    void check(const Chip8 &chip8) noexcept;
+};
@@ -0,0 +1,151 @@
+#include "audio.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+AudioOutput::AudioOutput(AudioConfig config)
+    : config_{config}, changes_{config.queue_capacity} {}
+
+void AudioOutput::report_sound_timer(u8 sound) noexcept {
+    // the beep sounds as long as the timer is above zero
+    const auto beeping = sound > 0;
+    if (beeping == reported_beeping_) {
+        return;
+    }
+    if (!changes_.push({beeping, clock::now()})) {
+        // try again after the next frame
+        dropped_changes_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    reported_beeping_ = beeping;
+}
+
+void AudioOutput::fill(std::span<float> samples) noexcept {
+    using namespace std::chrono;
+    const auto now = clock::now();
+    // the last sample of this buffer plays about one buffer from now
+    const auto buffer_time =
+        nanoseconds{seconds{samples.size()}} / config_.sample_rate;
+
+    auto change = Change{};
+    while (changes_.pop(change)) {
+        beeping_ = change.beeping;
+        const auto latency =
+            duration_cast<nanoseconds>(now - change.reported) + buffer_time;
+        changes_sounded_.fetch_add(1, std::memory_order_relaxed);
+        total_latency_ns_.fetch_add(latency.count(),
+                                    std::memory_order_relaxed);
+        if (latency.count() > max_latency_ns_.load(std::memory_order_relaxed)) {
+            max_latency_ns_.store(latency.count(), std::memory_order_relaxed);
+        }
+    }
+
+    if (!beeping_) {
+        std::ranges::fill(samples, 0.0f);
+        phase_ = 0;
+    } else {
+        // square wave, high for the first half of each period
+        for (auto &sample : samples) {
+            sample = phase_ < config_.sample_rate / 2 ? config_.volume
+                                                      : -config_.volume;
+            phase_ += config_.tone_hz;
+            if (phase_ >= config_.sample_rate) {
+                phase_ -= config_.sample_rate;
+            }
+        }
+    }
+    buffers_.fetch_add(1, std::memory_order_relaxed);
+}
+
+AudioOutput::Stats AudioOutput::take_stats() noexcept {
+    auto stats = Stats{};
+    stats.buffers = buffers_.exchange(0, std::memory_order_relaxed);
+    stats.dropped_changes =
+        dropped_changes_.exchange(0, std::memory_order_relaxed);
+    stats.changes = changes_sounded_.exchange(0, std::memory_order_relaxed);
+    stats.total_latency = std::chrono::nanoseconds{
+        total_latency_ns_.exchange(0, std::memory_order_relaxed)};
+    stats.max_latency = std::chrono::nanoseconds{
+        max_latency_ns_.exchange(0, std::memory_order_relaxed)};
+    return stats;
+}
+
+u32 ClockedAudioSink::start(AudioOutput &output) {
+    // not stop(), which would also finish whatever a subclass set up
+    ClockedAudioSink::stop();
+    running_ = true;
+    thread_ = std::thread{[this, &output] {
+        const auto &config = output.config();
+        const auto period =
+            std::chrono::duration_cast<AudioOutput::clock::duration>(
+                std::chrono::seconds{config.buffer_samples}) /
+            config.sample_rate;
+        std::vector<float> buffer(config.buffer_samples);
+        auto next = AudioOutput::clock::now();
+        while (running_) {
+            output.fill(buffer);
+            consume(buffer);
+            next += period;
+            std::this_thread::sleep_until(next);
+        }
+    }};
+    return 0;
+}
+
+void ClockedAudioSink::stop() {
+    running_ = false;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+u32 WavFileAudioSink::start(AudioOutput &output) {
+    stop();
+    file_ = std::fopen(path_.c_str(), "wb");
+    if (!file_) {
+        spdlog::error("Audio: could not open {}", path_.string());
+        return 10;
+    }
+    sample_rate_ = output.config().sample_rate;
+    samples_written_ = 0;
+    // written again with the final sizes once stopped
+    write_header();
+    return ClockedAudioSink::start(output);
+}
+
+void WavFileAudioSink::stop() {
+    ClockedAudioSink::stop();
+    if (file_) {
+        std::fseek(file_, 0, SEEK_SET);
+        write_header();
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+void WavFileAudioSink::consume(std::span<const float> samples) {
+    std::fwrite(samples.data(), sizeof(float), samples.size(), file_);
+    samples_written_ += static_cast<u32>(samples.size());
+}
+
+// RIFF header of a mono IEEE float WAV file, little endian hosts only
+void WavFileAudioSink::write_header() {
+    const u32 data_size = samples_written_ * sizeof(float);
+    const auto put = [this](const auto value) {
+        std::fwrite(&value, sizeof(value), 1, file_);
+    };
+    std::fwrite("RIFF", 1, 4, file_);
+    put(u32{36 + data_size});
+    std::fwrite("WAVEfmt ", 1, 8, file_);
+    put(u32{16});
+    put(u16{3}); // IEEE float
+    put(u16{1}); // mono
+    put(sample_rate_);
+    put(static_cast<u32>(sample_rate_ * sizeof(float)));
+    put(u16{sizeof(float)});
+    put(u16{32});
+    std::fwrite("data", 1, 4, file_);
+    put(data_size);
+}
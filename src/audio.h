@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <span>
+#include <thread>
+#include <utility>
+
+#include "common.h"
+#include "spsc_ring.h"
+
+struct AudioConfig {
+    u32 sample_rate = 44100;
+    // samples per buffer handed to the sink, smaller is lower latency
+    u32 buffer_samples = 512;
+    // sound timer changes the emulation thread can queue ahead of the sink
+    u32 queue_capacity = 64;
+    u32 tone_hz = 440;
+    float volume = 0.2f;
+};
+
+/// Generates the Chip8 beep. The emulation thread reports the sound timer
+/// after every frame, the changes travel through an SpscRing to the sink's
+/// callback thread, which fills buffers with a square wave while the timer
+/// is running.
+class AudioOutput {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats {
+        // buffers filled
+        u64 buffers = 0;
+        // sound timer changes which found the queue full
+        u64 dropped_changes = 0;
+        // changes which reached a buffer, and their latency from being
+        // reported to the end of the buffer they first sound in
+        u64 changes = 0;
+        std::chrono::nanoseconds total_latency{0};
+        std::chrono::nanoseconds max_latency{0};
+
+        std::chrono::nanoseconds average_latency() const noexcept {
+            if (changes == 0) {
+                return std::chrono::nanoseconds{0};
+            }
+            return total_latency / static_cast<std::int64_t>(changes);
+        }
+    };
+
+    explicit AudioOutput(AudioConfig config = {});
+
+    const AudioConfig &config() const noexcept { return config_; }
+
+    /// reports the sound timer after a frame, only queues a change when the
+    /// beep starts or stops. Only called by the emulation thread
+    void report_sound_timer(u8 sound) noexcept;
+
+    /// fills @param samples with the beep, only called by the sink's thread
+    void fill(std::span<float> samples) noexcept;
+
+    /// returns the stats gathered since the last call and resets them
+    Stats take_stats() noexcept;
+
+  private:
+    struct Change {
+        bool beeping;
+        clock::time_point reported;
+    };
+
+    AudioConfig config_;
+    SpscRing<Change> changes_;
+
+    // owned by the emulation thread
+    bool reported_beeping_ = false;
+
+    // owned by the sink's thread
+    bool beeping_ = false;
+    // position within one period of the tone, in units of 1 / sample_rate
+    u32 phase_ = 0;
+
+    // updated by both threads, read by take_stats()
+    std::atomic<u64> buffers_ = 0;
+    std::atomic<u64> dropped_changes_ = 0;
+    std::atomic<u64> changes_sounded_ = 0;
+    std::atomic<std::int64_t> total_latency_ns_ = 0;
+    std::atomic<std::int64_t> max_latency_ns_ = 0;
+};
+
+/// Where the samples of an AudioOutput go. A sink pulls buffers of
+/// config().buffer_samples samples on its own thread between start() and
+/// stop().
+class AudioSink {
+  public:
+    virtual ~AudioSink() = default;
+
+    /// starts pulling from @param output, returns 0 on success
+    virtual u32 start(AudioOutput &output) = 0;
+    virtual void stop() = 0;
+};
+
+/// Pulls buffers at the rate a sound card would and hands them to
+/// consume(), for running without one.
+class ClockedAudioSink : public AudioSink {
+  public:
+    ~ClockedAudioSink() override { stop(); }
+
+    u32 start(AudioOutput &output) override;
+    void stop() override;
+
+  protected:
+    virtual void consume(std::span<const float> samples) = 0;
+
+  private:
+    std::thread thread_;
+    std::atomic<bool> running_ = false;
+};
+
+/// Discards every buffer.
+class NullAudioSink final : public ClockedAudioSink {
+  public:
+    ~NullAudioSink() override { stop(); }
+
+  protected:
+    void consume(std::span<const float>) override {}
+};
+
+/// Writes every buffer to a 32-bit float mono WAV file.
+class WavFileAudioSink final : public ClockedAudioSink {
+  public:
+    explicit WavFileAudioSink(std::filesystem::path path)
+        : path_{std::move(path)} {}
+    ~WavFileAudioSink() override { stop(); }
+
+    /// opens the file, returns 0 on success
+    u32 start(AudioOutput &output) override;
+    /// stops pulling and completes the file
+    void stop() override;
+
+  protected:
+    void consume(std::span<const float> samples) override;
+
+  private:
+    std::filesystem::path path_;
+    std::FILE *file_ = nullptr;
+    u32 sample_rate_ = 0;
+    u32 samples_written_ = 0;
+
+    void write_header();
+};
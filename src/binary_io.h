@@ -0,0 +1,19 @@
+#pragma once
+
+#include <istream>
+#include <ostream>
+#include <type_traits>
+
+// Helpers for the binary files of the emulator, movies and saved states.
+// Fields are written one by one in host byte order, so no padding reaches
+// the file.
+
+template <typename T> void write_field(std::ostream &out, const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T> void read_field(std::istream &in, T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    in.read(reinterpret_cast<char *>(&value), sizeof(value));
+}
@@ -1,223 +1,1190 @@
 #include "chip8.h"
+#include "aot.h"
 #include "common.h"
+#include "jit_x64.h"
 #include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <utility>
 
-void Chip8::execute(u16 opcode) noexcept {
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+Chip8Core<Variant, Quirks, MemoryModel>::Chip8Core() {
+    memory_.share(font_image());
+}
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+Chip8Core<Variant, Quirks, MemoryModel>::~Chip8Core() = default;
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+Chip8Core<Variant, Quirks, MemoryModel>::Chip8Core(
+    Chip8Core &&) noexcept = default;
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+Chip8Core<Variant, Quirks, MemoryModel> &
+Chip8Core<Variant, Quirks, MemoryModel>::operator=(
+    Chip8Core &&) noexcept = default;
+
+namespace {
+
+// the opcode bits a handler is specialized on
+constexpr u16 NO_FIELDS = 0x0000;
+constexpr u16 X_FIELD = 0x0F00;
+constexpr u16 XY_FIELDS = 0x0FF0;
+
+// same as Chip8Core::Dispatch, which is private
+template <typename Core> using Dispatch = void (*)(Core &, u16) noexcept;
+
+// the Chip8Core a handler belongs to
+template <typename> struct handler_class;
+template <typename Core, typename Function>
+struct handler_class<Function Core::*> {
+    using type = Core;
+};
+template <auto Handler>
+using HandlerClass = typename handler_class<decltype(Handler)>::type;
+
+// calls @tparam Handler with the bits under @tparam Mask replaced by the
+// constant @tparam Fields, once the handler is inlined its register indices
+// fold into the addressing
+template <auto Handler, u16 Mask, u16 Fields>
+void dispatch(HandlerClass<Handler> &chip8, u16 opcode) noexcept {
+    (chip8.*Handler)(static_cast<u16>((opcode & ~Mask) | Fields));
+}
+
+template <auto Handler, u16 Mask, std::size_t... Values>
+constexpr std::array<Dispatch<HandlerClass<Handler>>, sizeof...(Values)>
+specialize(std::index_sequence<Values...>) noexcept {
+    return {&dispatch<Handler, Mask,
+                      static_cast<u16>(Values << std::countr_zero(Mask))>...};
+}
+
+// dispatch<Handler, Mask, Fields> for every value of the bits under Mask
+template <auto Handler, u16 Mask>
+constexpr auto SPECIALIZATIONS = specialize<Handler, Mask>(
+    std::make_index_sequence<(Mask >> std::countr_zero(Mask)) + 1>{});
+
+template <auto Handler, u16 Mask>
+constexpr Dispatch<HandlerClass<Handler>> specialized(u16 opcode) noexcept {
+    return SPECIALIZATIONS<Handler, Mask>[(opcode & Mask) >>
+                                          std::countr_zero(Mask)];
+}
+
+// doubles every bit of @param bits, which draws a sprite row in lores
+constexpr u64 double_bits(u32 bits) noexcept {
+    u64 doubled = 0x0;
+    for (auto bit = 0u; bit < 32; ++bit) {
+        doubled |= u64{(bits >> bit) & 0x1u} * 0x3u << (2 * bit);
+    }
+    return doubled;
+}
+
+} // namespace
+
+/// returns the specialized handler execute() calls for @param opcode
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+constexpr typename Chip8Core<Variant, Quirks, MemoryModel>::Dispatch
+Chip8Core<Variant, Quirks, MemoryModel>::dispatch_entry(u16 opcode) noexcept {
+    switch (Variant::decode(opcode)) {
+    case Op::_0NNN:
+        return specialized<&Chip8Core::_0NNN, NO_FIELDS>(opcode);
+    case Op::_00E0:
+        return specialized<&Chip8Core::_00E0, NO_FIELDS>(opcode);
+    case Op::_00EE:
+        return specialized<&Chip8Core::_00EE, NO_FIELDS>(opcode);
+    case Op::_1NNN:
+        return specialized<&Chip8Core::_1NNN, NO_FIELDS>(opcode);
+    case Op::_2NNN:
+        return specialized<&Chip8Core::_2NNN, NO_FIELDS>(opcode);
+    case Op::_3XNN:
+        return specialized<&Chip8Core::_3XNN, X_FIELD>(opcode);
+    case Op::_4XNN:
+        return specialized<&Chip8Core::_4XNN, X_FIELD>(opcode);
+    case Op::_6XNN:
+        return specialized<&Chip8Core::_6XNN, X_FIELD>(opcode);
+    case Op::_7XNN:
+        return specialized<&Chip8Core::_7XNN, X_FIELD>(opcode);
+    case Op::_8XY0:
+        return specialized<&Chip8Core::_8XY0, XY_FIELDS>(opcode);
+    case Op::_8XY1:
+        return specialized<&Chip8Core::_8XY1, XY_FIELDS>(opcode);
+    case Op::_8XY2:
+        return specialized<&Chip8Core::_8XY2, XY_FIELDS>(opcode);
+    case Op::_8XY3:
+        return specialized<&Chip8Core::_8XY3, XY_FIELDS>(opcode);
+    case Op::_8XY6:
+        return specialized<&Chip8Core::_8XY6, XY_FIELDS>(opcode);
+    case Op::_8XYE:
+        return specialized<&Chip8Core::_8XYE, XY_FIELDS>(opcode);
+    case Op::_ANNN:
+        return specialized<&Chip8Core::_ANNN, NO_FIELDS>(opcode);
+    case Op::_BNNN:
+        return specialized<&Chip8Core::_BNNN, X_FIELD>(opcode);
+    case Op::_DXYN:
+        return specialized<&Chip8Core::_DXYN, XY_FIELDS>(opcode);
+    case Op::_EX9E:
+        return specialized<&Chip8Core::_EX9E, X_FIELD>(opcode);
+    case Op::_EXA1:
+        return specialized<&Chip8Core::_EXA1, X_FIELD>(opcode);
+    case Op::_FX07:
+        return specialized<&Chip8Core::_FX07, X_FIELD>(opcode);
+    case Op::_FX0A:
+        return specialized<&Chip8Core::_FX0A, X_FIELD>(opcode);
+    case Op::_FX15:
+        return specialized<&Chip8Core::_FX15, X_FIELD>(opcode);
+    case Op::_FX18:
+        return specialized<&Chip8Core::_FX18, X_FIELD>(opcode);
+    case Op::_FX33:
+        return specialized<&Chip8Core::_FX33, X_FIELD>(opcode);
+    case Op::_FX55:
+        return specialized<&Chip8Core::_FX55, X_FIELD>(opcode);
+    case Op::_FX65:
+        return specialized<&Chip8Core::_FX65, X_FIELD>(opcode);
+    case Op::_00CN:
+        return specialized<&Chip8Core::_00CN, NO_FIELDS>(opcode);
+    case Op::_00DN:
+        return specialized<&Chip8Core::_00DN, NO_FIELDS>(opcode);
+    case Op::_00FB:
+        return specialized<&Chip8Core::_00FB, NO_FIELDS>(opcode);
+    case Op::_00FC:
+        return specialized<&Chip8Core::_00FC, NO_FIELDS>(opcode);
+    case Op::_00FD:
+        return specialized<&Chip8Core::_00FD, NO_FIELDS>(opcode);
+    case Op::_00FE:
+        return specialized<&Chip8Core::_00FE, NO_FIELDS>(opcode);
+    case Op::_00FF:
+        return specialized<&Chip8Core::_00FF, NO_FIELDS>(opcode);
+    case Op::_5XY2:
+        return specialized<&Chip8Core::_5XY2, XY_FIELDS>(opcode);
+    case Op::_5XY3:
+        return specialized<&Chip8Core::_5XY3, XY_FIELDS>(opcode);
+    case Op::_F000:
+        return specialized<&Chip8Core::_F000, NO_FIELDS>(opcode);
+    case Op::_FN01:
+        return specialized<&Chip8Core::_FN01, X_FIELD>(opcode);
+    case Op::unknown:
+        return specialized<&Chip8Core::_UNKNOWN, NO_FIELDS>(opcode);
+    // decoded but not implemented by the interpreter, they execute as no-ops
+    case Op::_5XY0:
+    case Op::_8XY4:
+    case Op::_8XY5:
+    case Op::_8XY7:
+    case Op::_9XY0:
+    case Op::_CXNN:
+    case Op::_FX1E:
+    case Op::_FX29:
+    case Op::_FX30:
+    case Op::_FX75:
+    case Op::_FX85:
+    case Op::_F002:
+    case Op::_FX3A:
+        return specialized<&Chip8Core::_NOOP, NO_FIELDS>(opcode);
+    }
+    // every Op is handled above, -Wswitch points out a new one
+    return specialized<&Chip8Core::_UNKNOWN, NO_FIELDS>(opcode);
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+constexpr std::array<
+    typename Chip8Core<Variant, Quirks, MemoryModel>::Dispatch, 0x10000>
+Chip8Core<Variant, Quirks, MemoryModel>::make_dispatch_table() noexcept {
+    auto table = std::array<Dispatch, 0x10000>{};
+    for (auto opcode = 0u; opcode < table.size(); ++opcode) {
+        table[opcode] = dispatch_entry(static_cast<u16>(opcode));
+    }
+    return table;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+constexpr std::array<
+    typename Chip8Core<Variant, Quirks, MemoryModel>::Dispatch, 0x10000>
+    Chip8Core<Variant, Quirks, MemoryModel>::DISPATCH_TABLE =
+        make_dispatch_table();
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::execute(u16 opcode) noexcept {
     // clear bad_opcode if it was previously set
     clear_bad_opcode();
 
-    u16 first_nibble = nibble(nib::first, opcode);
-    spdlog::debug("In execute(): first_nibble = {:x}", first_nibble);
-    switch (first_nibble) {
-    case 0x0: {
-        // 00E0 instruction
-        if (opcode == 0x00E0) {
-            _00E0(opcode);
-        }
-        // 00EE instruction
-        else if (opcode == 0x00EE) {
-            _00EE(opcode);
-        }
-        // 0NNN instruction
-        else {
-            _0NNN(opcode);
-        }
+    CHIP8_TRACE(decode, "In execute(): op = {}",
+                op_name(Variant::decode(opcode)));
+    DISPATCH_TABLE[opcode](*this, opcode);
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::execute_switch(
+    u16 opcode) noexcept {
+    // clear bad_opcode if it was previously set
+    clear_bad_opcode();
+
+    const auto op = Variant::decode(opcode);
+    CHIP8_TRACE(decode, "In execute_switch(): op = {}", op_name(op));
+    switch (op) {
+    case Op::_0NNN:
+        _0NNN(opcode);
         break;
-    }
-    case 0x1:
+    case Op::_00E0:
+        _00E0(opcode);
+        break;
+    case Op::_00EE:
+        _00EE(opcode);
+        break;
+    case Op::_1NNN:
         _1NNN(opcode);
         break;
-    case 0x2:
+    case Op::_2NNN:
         _2NNN(opcode);
         break;
-    case 0x3:
+    case Op::_3XNN:
+        _3XNN(opcode);
         break;
-    case 0x4:
+    case Op::_4XNN:
+        _4XNN(opcode);
         break;
-    case 0x5:
-        break;
-    case 0x6:
+    case Op::_6XNN:
         _6XNN(opcode);
         break;
-    case 0x7:
+    case Op::_7XNN:
         _7XNN(opcode);
         break;
-    case 0x8: {
-        const auto fourth_nibble = nibble(nib::fourth, opcode);
-        switch (fourth_nibble) {
-        case 0x0:
-            _8XY0(opcode);
-            break;
-        case 0x1:
-            _8XY1(opcode);
-            break;
-        case 0x2:
-            _8XY2(opcode);
-            break;
-        case 0x3:
-            _8XY3(opcode);
-            break;
-        case 0x4:
-            break;
-        case 0x5:
-            break;
-        case 0x6:
-            break;
-        case 0x7:
-            break;
-        case 0xE:
-            break;
-        }
+    case Op::_8XY0:
+        _8XY0(opcode);
         break;
-    }
-    case 0x9:
+    case Op::_8XY1:
+        _8XY1(opcode);
         break;
-    case 0xA:
-        _ANNN(opcode);
+    case Op::_8XY2:
+        _8XY2(opcode);
+        break;
+    case Op::_8XY3:
+        _8XY3(opcode);
         break;
-    case 0xB:
+    case Op::_8XY6:
+        _8XY6(opcode);
         break;
-    case 0xC:
+    case Op::_8XYE:
+        _8XYE(opcode);
         break;
-    case 0xD:
+    case Op::_ANNN:
+        _ANNN(opcode);
+        break;
+    case Op::_BNNN:
+        _BNNN(opcode);
+        break;
+    case Op::_DXYN:
         _DXYN(opcode);
         break;
-    case 0xE:
+    case Op::_EX9E:
+        _EX9E(opcode);
+        break;
+    case Op::_EXA1:
+        _EXA1(opcode);
+        break;
+    case Op::_FX07:
+        _FX07(opcode);
+        break;
+    case Op::_FX0A:
+        _FX0A(opcode);
+        break;
+    case Op::_FX15:
+        _FX15(opcode);
+        break;
+    case Op::_FX18:
+        _FX18(opcode);
+        break;
+    case Op::_FX33:
+        _FX33(opcode);
+        break;
+    case Op::_FX55:
+        _FX55(opcode);
+        break;
+    case Op::_FX65:
+        _FX65(opcode);
+        break;
+    case Op::_00CN:
+        _00CN(opcode);
+        break;
+    case Op::_00DN:
+        _00DN(opcode);
+        break;
+    case Op::_00FB:
+        _00FB(opcode);
+        break;
+    case Op::_00FC:
+        _00FC(opcode);
+        break;
+    case Op::_00FD:
+        _00FD(opcode);
         break;
-    case 0xF:
+    case Op::_00FE:
+        _00FE(opcode);
         break;
+    case Op::_00FF:
+        _00FF(opcode);
+        break;
+    case Op::_5XY2:
+        _5XY2(opcode);
+        break;
+    case Op::_5XY3:
+        _5XY3(opcode);
+        break;
+    case Op::_F000:
+        _F000(opcode);
+        break;
+    case Op::_FN01:
+        _FN01(opcode);
+        break;
+    case Op::unknown:
+        _UNKNOWN(opcode);
+        break;
+    // decoded but not implemented by the interpreter, they execute as no-ops
+    case Op::_5XY0:
+    case Op::_8XY4:
+    case Op::_8XY5:
+    case Op::_8XY7:
+    case Op::_9XY0:
+    case Op::_CXNN:
+    case Op::_FX1E:
+    case Op::_FX29:
+    case Op::_FX30:
+    case Op::_FX75:
+    case Op::_FX85:
+    case Op::_F002:
+    case Op::_FX3A:
+        _NOOP(opcode);
+        break;
+    }
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+u32 Chip8Core<Variant, Quirks, MemoryModel>::run(u32 cycles) noexcept {
+    // the profiler counts instructions in cycle()
+    if constexpr (JIT) {
+        if (aot_ && !profiling()) {
+            return aot_->run(*this, cycles);
+        }
+        if (backend_ == Backend::jit && !profiling()) {
+            return jit_->run(*this, cycles);
+        }
+    }
+    if (backend_ == Backend::block_cache && !profiling()) {
+        return run_blocks(cycles);
+    }
+
+    for (auto executed = 0u; executed < cycles;) {
+        // halt instead of fetching past the end of memory
+        if (state_.pc >= MEMORY_SIZE - 1) {
+            return executed;
+        }
+        const auto pc = state_.pc;
+        cycle();
+        ++executed;
+        // idle loops are entered by a jump
+        if (state_.pc != pc + 2) {
+            executed += skip_idle(cycles - executed);
+        }
+    }
+    return cycles;
+}
+
+// a loop which leaves the state as it found it, so running it is the same
+// as running it once. Returns its length in instructions, 0 if there is none
+// at the pc
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+u32 Chip8Core<Variant, Quirks, MemoryModel>::idle_loop_length() const noexcept {
+    const auto pc = state_.pc;
+    const u16 opcode = (memory_[pc] << 8) + memory_[pc + 1];
+    const auto op = Variant::decode(opcode);
+    // jump to self, or the SUPER-CHIP exit which works like one
+    if ((op == Op::_1NNN && (opcode & 0x0FFF) == pc) || op == Op::_00FD) {
+        return 1;
+    }
+    // waiting for a key, which only changes between frames
+    if (op == Op::_FX0A && state_.keys == 0) {
+        return 1;
+    }
+    // polling the delay timer, which only changes between frames:
+    //   FX07, 3XNN or 4XNN, jump back to the FX07
+    if (op == Op::_FX07) {
+        const auto X = nibble(nib::second, opcode);
+        const u16 test = (memory_[pc + 2] << 8) + memory_[pc + 3];
+        const u16 jump = (memory_[pc + 4] << 8) + memory_[pc + 5];
+        if (jump != (0x1000 | pc) || nibble(nib::second, test) != X ||
+            state_.V[X] != state_.delay) {
+            return 0;
+        }
+        const auto NN = test & 0x00FF;
+        if ((Variant::decode(test) == Op::_3XNN && state_.delay != NN) ||
+            (Variant::decode(test) == Op::_4XNN && state_.delay == NN)) {
+            return 3;
+        }
+    }
+    return 0;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+u32 Chip8Core<Variant, Quirks, MemoryModel>::skip_idle(u32 remaining) noexcept {
+    if (!idle_skip_ || remaining == 0 || state_.pc >= MEMORY_SIZE - 5) {
+        return 0;
+    }
+    const auto length = idle_loop_length();
+    if (length == 0) {
+        return 0;
+    }
+    // whole iterations only, so the pc ends up where running them would
+    // leave it. Running them would also clear bad_opcode
+    const auto skipped = remaining - remaining % length;
+    if (skipped > 0) {
+        clear_bad_opcode();
+        idle_cycles_skipped_ += skipped;
+    }
+    if (profiling()) {
+        for (auto i = 0u; i < length; ++i) {
+            const auto pc = static_cast<u16>(state_.pc + 2 * i);
+            const u16 opcode = (memory_[pc] << 8) + memory_[pc + 1];
+            profiler_->record(pc, opcode, stack(), skipped / length);
+        }
+    }
+    return skipped;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+std::shared_ptr<
+    const typename Chip8Core<Variant, Quirks, MemoryModel>::Memory::Image>
+Chip8Core<Variant, Quirks, MemoryModel>::make_image(std::span<const u8> rom) {
+    auto image = std::make_shared<typename Memory::Image>();
+    std::ranges::copy(FONT, image->begin() + FONT_START);
+    const auto size = std::min<std::size_t>(rom.size(), MAX_ROM_SIZE);
+    std::copy_n(rom.begin(), size, image->begin() + ROM_START);
+    return image;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+auto Chip8Core<Variant, Quirks, MemoryModel>::font_image()
+    -> const std::shared_ptr<const typename Memory::Image> & {
+    static const auto image = make_image({});
+    return image;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::reset() noexcept {
+    state_ = Machine{};
+    memory_.share(font_image());
+    flush_blocks();
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::set_backend(Backend backend) {
+    if (backend == Backend::jit && !JIT) {
+        spdlog::warn("The jit only translates CHIP-8 with its default quirks, "
+                     "using the block cache");
+        backend = Backend::block_cache;
+    }
+    if (backend == Backend::jit && !Jit::supported()) {
+        spdlog::warn("The jit is not supported on this host, using the "
+                     "interpreter");
+        backend = Backend::interpreter;
+    }
+    backend_ = backend;
+    if (backend_ == Backend::block_cache && !block_cache_) {
+        block_cache_ = std::make_unique<BlockCache>();
+    }
+    if (backend_ == Backend::jit && !jit_) {
+        jit_ = std::make_unique<Jit>();
+    }
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::set_program(
+    const AotProgram *program) {
+    if (program && !JIT) {
+        spdlog::warn("Programs are only translated for CHIP-8 with its "
+                     "default quirks, ignoring {}",
+                     program->name);
+        program = nullptr;
+    }
+    aot_ = program ? std::make_unique<Aot>(*program) : nullptr;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+bool Chip8Core<Variant, Quirks, MemoryModel>::translated(
+    u16 address) const noexcept {
+    return (jit_ && jit_->covers(address)) || (aot_ && aot_->covers(address));
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::flush_blocks() noexcept {
+    if (jit_) {
+        jit_->flush();
+    }
+    if (aot_) {
+        aot_->flush();
+    }
+    if (!block_cache_) {
+        return;
+    }
+    block_cache_->blocks.clear();
+    block_cache_->block_at.fill(0);
+    block_cache_->code.reset();
+    ++block_cache_->generation;
+}
+
+// decodes instructions from @param start up to and including the first one
+// which can leave the straight line path
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+const typename Chip8Core<Variant, Quirks, MemoryModel>::Block &
+Chip8Core<Variant, Quirks, MemoryModel>::build_block(u16 start) {
+    auto &cache = *block_cache_;
+    auto &block = cache.blocks.emplace_back();
+    block.start = start;
+
+    auto address = start;
+    while (address < MEMORY_SIZE - 1 && block.ops.size() < MAX_BLOCK_LENGTH) {
+        const u16 opcode = (memory_[address] << 8) + memory_[address + 1];
+        const auto op = Variant::decode(opcode);
+        block.ops.push_back({DISPATCH_TABLE[opcode], opcode});
+        cache.code.set(address);
+        cache.code.set(address + 1);
+        address += 2;
+        if (ends_block(op)) {
+            break;
+        }
+    }
+    block.end = address;
+    if (fusion_) {
+        fuse(block);
+    }
+
+    cache.block_at[start] = static_cast<u16>(cache.blocks.size());
+    CHIP8_TRACE(decode, "Built block {:x}-{:x} with {} instructions", start,
+                block.end, block.ops.size());
+    return block;
+}
+
+// marks the sequences in @param block which run as one superinstruction.
+// The instructions stay in place so a block can still be entered or cut
+// short in the middle of one
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::fuse(
+    Block &block) const noexcept {
+    auto &ops = block.ops;
+    for (auto i = 0u; i + 1 < ops.size();) {
+        const auto first = Variant::decode(ops[i].opcode);
+        const auto second = Variant::decode(ops[i + 1].opcode);
+        auto length = 1u;
+        if (first == Op::_ANNN && second == Op::_DXYN) {
+            ops[i].fused = &fused_draw;
+            length = 2;
+        } else if (first == Op::_7XNN && second == Op::_3XNN) {
+            ops[i].fused = &fused_add_skip;
+            length = 2;
+        } else if (first == Op::_6XNN && second == Op::_6XNN) {
+            while (i + length < ops.size() && length < MAX_FUSED_LENGTH &&
+                   Variant::decode(ops[i + length].opcode) == Op::_6XNN) {
+                ++length;
+            }
+            ops[i].fused = &fused_loads;
+        }
+        ops[i].length = static_cast<u8>(length);
+        i += length;
     }
+}
 
-    // TODO: increment pc
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::fused_draw(Chip8Core &chip8,
+                                     const DecodedOp *ops) noexcept {
+    chip8._ANNN(ops[0].opcode);
+    chip8._DXYN(ops[1].opcode);
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::fused_loads(Chip8Core &chip8,
+                                     const DecodedOp *ops) noexcept {
+    for (auto i = 0u; i < ops->length; ++i) {
+        chip8._6XNN(ops[i].opcode);
+    }
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::fused_add_skip(Chip8Core &chip8,
+                                     const DecodedOp *ops) noexcept {
+    chip8._7XNN(ops[0].opcode);
+    chip8._3XNN(ops[1].opcode);
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+u32 Chip8Core<Variant, Quirks, MemoryModel>::run_blocks(u32 cycles) noexcept {
+    auto &cache = *block_cache_;
+    auto executed = 0u;
+
+    while (executed < cycles) {
+        const auto start = state_.pc;
+        if (start >= MEMORY_SIZE - 1) {
+            break;
+        }
+        // blocks start at jump targets, where idle loops are entered
+        if (const auto skipped = skip_idle(cycles - executed); skipped > 0) {
+            executed += skipped;
+            continue;
+        }
+        const auto index = cache.block_at[start];
+        const auto &block =
+            index != 0 ? cache.blocks[index - 1] : build_block(start);
+        const auto generation = cache.generation;
+
+        for (auto i = 0u; i < block.ops.size();) {
+            if (executed == cycles) {
+                return executed;
+            }
+            const auto &decoded = block.ops[i];
+            // a superinstruction runs whole or not at all, so it is taken
+            // apart when the cycles run out in its middle
+            const auto length =
+                decoded.fused && decoded.length <= cycles - executed
+                    ? decoded.length
+                    : 1u;
+            const u16 next = state_.pc + 2 * length;
+            state_.pc = next;
+            // none of the fused instructions sets bad_opcode
+            clear_bad_opcode();
+            if (length > 1) {
+                decoded.fused(*this, &decoded);
+            } else {
+                decoded.handler(*this, decoded.opcode);
+            }
+            executed += length;
+            i += length;
+            // leave the block if the pc was moved or the block was flushed
+            // by a write into cached code
+            if (state_.pc != next || cache.generation != generation) {
+                break;
+            }
+        }
+    }
+    return executed;
+}
+
+// scroll amounts count pixels at the current resolution
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::scroll_vertical(
+    int rows) noexcept {
+    const auto distance = static_cast<u32>(std::abs(rows)) * (hires() ? 1 : 2);
+    for (auto plane = 0u; plane < PLANES; ++plane) {
+        if (!((selected_planes() >> plane) & 0x1u)) {
+            continue;
+        }
+        const auto screen = plane_rows(plane);
+        const auto kept = SCREEN_HEIGHT - std::min(distance, SCREEN_HEIGHT);
+        if (rows > 0) {
+            std::shift_right(screen.begin(), screen.end(), distance);
+            std::fill_n(screen.begin(), SCREEN_HEIGHT - kept, Row{0x0});
+        } else {
+            std::shift_left(screen.begin(), screen.end(), distance);
+            std::fill(screen.begin() + kept, screen.end(), Row{0x0});
+        }
+    }
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void Chip8Core<Variant, Quirks, MemoryModel>::scroll_horizontal(
+    int columns) noexcept {
+    const auto distance =
+        static_cast<u32>(std::abs(columns)) * (hires() ? 1 : 2);
+    for (auto plane = 0u; plane < PLANES; ++plane) {
+        if (!((selected_planes() >> plane) & 0x1u)) {
+            continue;
+        }
+        for (auto &row : plane_rows(plane)) {
+            row = columns > 0 ? row >> distance : row << distance;
+        }
+    }
 }
 
 // instructions
+// Instructions which are decoded but not implemented yet
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_NOOP(
+    [[maybe_unused]] u16 opcode) noexcept {}
+
+// Opcodes which are not part of the instruction set
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_UNKNOWN(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(decode, "Unknown opcode {:x}", opcode);
+    state_.bad_opcode = true;
+}
+
 // Execute machine language instruction, UNIMPLEMENTED
-void inline Chip8::_0NNN([[maybe_unused]] u16 opcode) noexcept {
-    spdlog::debug("In 0NNN: NNN = {:x}", opcode & 0x0FFF);
-    bad_opcode_ = true;
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_0NNN(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(decode, "In 0NNN: NNN = {:x}", opcode & 0x0FFF);
+    state_.bad_opcode = true;
 }
 
 // Clear the screen
-void inline Chip8::_00E0([[maybe_unused]] u16 opcode) noexcept {
-    spdlog::debug("In 00E0");
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00E0(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(draw, "In 00E0");
     clear_screen();
 }
 
 // Return from subroutine popping from stack and setting PC
-void inline Chip8::_00EE([[maybe_unused]] u16 opcode) noexcept {
-    spdlog::debug("In 00EE");
-    assert(stack_.size() > 0);
-    pc_ = stack_.top();
-    stack_.pop();
+// Returning with an empty stack sets the stack fault flag instead
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00EE(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(stack, "In 00EE: sp = {}", state_.sp);
+    if (state_.sp == 0) {
+        state_.stack_fault = true;
+        return;
+    }
+    state_.pc = state_.stack[--state_.sp];
 }
 
 // Jump to address 0xNNN
-void inline Chip8::_1NNN(u16 opcode) noexcept {
-    spdlog::debug("In 1NNN: NNN = {:x}", opcode & 0x0FFF);
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_1NNN(
+    u16 opcode) noexcept {
+    CHIP8_TRACE(registers, "In 1NNN: NNN = {:x}", opcode & 0x0FFF);
     u16 address = 0x0FFF & opcode;
-    pc_ = address;
+    state_.pc = address;
 }
 
 // Execute subroutine at address 0xNNN pushing current PC onto stack
-void inline Chip8::_2NNN(u16 opcode) noexcept {
-    spdlog::debug("In 2NNN: NNN = {:x}", opcode & 0x0FFF);
-    stack_.push(pc_);
+// Calling with a full stack sets the stack fault flag instead
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_2NNN(
+    u16 opcode) noexcept {
+    CHIP8_TRACE(stack, "In 2NNN: NNN = {:x}", opcode & 0x0FFF);
+    if (state_.sp == STACK_SIZE) {
+        state_.stack_fault = true;
+        return;
+    }
+    state_.stack[state_.sp++] = state_.pc;
     u16 address = 0x0FFF & opcode;
-    pc_ = address;
+    state_.pc = address;
+}
+
+// Skip the next instruction if VX equals 0xNN
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_3XNN(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In 3XNN: X = {:x}, NN = {:x}", second_nibble,
+                opcode & 0x00FF);
+    if (state_.V[second_nibble] == (opcode & 0x00FF)) {
+        skip();
+    }
+}
+
+// Skip the next instruction if VX does not equal 0xNN
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_4XNN(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In 4XNN: X = {:x}, NN = {:x}", second_nibble,
+                opcode & 0x00FF);
+    if (state_.V[second_nibble] != (opcode & 0x00FF)) {
+        skip();
+    }
 }
 
 // Store 0xNN into register VX
-void inline Chip8::_6XNN(u16 opcode) noexcept {
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_6XNN(
+    u16 opcode) noexcept {
     const auto second_nibble = nibble(nib::second, opcode);
-    spdlog::debug("In 6XNN: X = {:x}, NN = {:x}", second_nibble,
-                  opcode & 0x00FF);
-    V_[second_nibble] = opcode & 0x00FF;
+    CHIP8_TRACE(registers, "In 6XNN: X = {:x}, NN = {:x}", second_nibble,
+                opcode & 0x00FF);
+    state_.V[second_nibble] = opcode & 0x00FF;
 }
 
 // Add value 0xNN to register VX
-void inline Chip8::_7XNN(u16 opcode) noexcept {
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_7XNN(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In 7XNN: X = {:x}, NN = {:x}", second_nibble,
+                opcode & 0x00FF);
+    state_.V[second_nibble] += opcode & 0x00FF;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_8XY0(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    const auto third_nibble = nibble(nib::third, opcode);
+    state_.V[second_nibble] = state_.V[third_nibble];
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_8XY1(
+    u16 opcode) noexcept {
     const auto second_nibble = nibble(nib::second, opcode);
-    spdlog::debug("In 7XNN: X = {:x}, NN = {:x}", second_nibble,
-                  opcode & 0x00FF);
-    V_[second_nibble] += opcode & 0x00FF;
+    const auto third_nibble = nibble(nib::third, opcode);
+    state_.V[second_nibble] |= state_.V[third_nibble];
 }
 
-void inline Chip8::_8XY0(u16 opcode) noexcept {
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_8XY2(
+    u16 opcode) noexcept {
     const auto second_nibble = nibble(nib::second, opcode);
     const auto third_nibble = nibble(nib::third, opcode);
-    V_[second_nibble] = V_[third_nibble];
+    state_.V[second_nibble] &= state_.V[third_nibble];
 }
 
-void inline Chip8::_8XY1(u16 opcode) noexcept {
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_8XY3(
+    u16 opcode) noexcept {
     const auto second_nibble = nibble(nib::second, opcode);
     const auto third_nibble = nibble(nib::third, opcode);
-    V_[second_nibble] |= V_[third_nibble];
+    state_.V[second_nibble] ^= state_.V[third_nibble];
 }
 
-void inline Chip8::_8XY2(u16 opcode) noexcept {
+// Shift VX right by one, or VY into VX with the SHIFT_VY quirk. Set VF to
+// the bit shifted out
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_8XY6(
+    u16 opcode) noexcept {
     const auto second_nibble = nibble(nib::second, opcode);
     const auto third_nibble = nibble(nib::third, opcode);
-    V_[second_nibble] &= V_[third_nibble];
+    const u8 value =
+        state_.V[Quirks::SHIFT_VY ? third_nibble : second_nibble];
+    state_.V[second_nibble] = value >> 1;
+    state_.V[0xF] = value & 0x1;
 }
 
-void inline Chip8::_8XY3(u16 opcode) noexcept {
+// Shift VX left by one, or VY into VX with the SHIFT_VY quirk. Set VF to
+// the bit shifted out
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_8XYE(
+    u16 opcode) noexcept {
     const auto second_nibble = nibble(nib::second, opcode);
     const auto third_nibble = nibble(nib::third, opcode);
-    V_[second_nibble] ^= V_[third_nibble];
+    const u8 value =
+        state_.V[Quirks::SHIFT_VY ? third_nibble : second_nibble];
+    state_.V[second_nibble] = static_cast<u8>(value << 1);
+    state_.V[0xF] = value >> 7;
+}
+
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_ANNN(
+    u16 opcode) noexcept {
+    CHIP8_TRACE(registers, "In ANNN: NNN = {:x}", opcode & 0x0FFF);
+    state_.I = opcode & 0x0FFF;
 }
 
-void inline Chip8::_ANNN(u16 opcode) noexcept {
-    spdlog::debug("In ANNN: NNN = {:x}", opcode & 0x0FFF);
-    I_ = opcode & 0x0FFF;
+// Jump to 0xNNN plus V0, or plus VX with the JUMP_VX quirk
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_BNNN(
+    u16 opcode) noexcept {
+    const auto reg = Quirks::JUMP_VX ? nibble(nib::second, opcode) : 0x0;
+    CHIP8_TRACE(registers, "In BNNN: NNN = {:x}, V{:x} = {:x}",
+                opcode & 0x0FFF, reg, state_.V[reg]);
+    state_.pc = static_cast<u16>((opcode & 0x0FFF) + state_.V[reg]);
 }
 
 // Draw sprite at position VX, VY with 0xN bytes of sprite data
 // starting at the address stored in I
 // Set VF to 0x01 if any set pixels are changed to unset, and 00 otherwise
-void inline Chip8::_DXYN(u16 opcode) noexcept {
+// SUPER-CHIP and XO-CHIP draw a 16x16 sprite of two bytes per row for DXY0,
+// double every pixel until switched to hires and draw a sprite into each
+// selected bitplane, the data for each plane following the last
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_DXYN(
+    u16 opcode) noexcept {
+    // in lores every pixel covers 2x2 pixels of the screen
+    const u32 scale = hires() ? 1 : 2;
     // get x and y coords from VX, VY modulo screen size
-    const auto x_start = V_[nibble(nib::second, opcode)] % SCREEN_WIDTH;
-    const auto x_end = std::min(static_cast<u32>(x_start + 8u), SCREEN_WIDTH);
-    const auto y_start = V_[nibble(nib::third, opcode)] % SCREEN_HEIGHT;
-    const auto pixel_height = nibble(nib::fourth, opcode);
-    const auto y_end =
-        std::min(static_cast<u32>(y_start + pixel_height), SCREEN_HEIGHT);
-
-    spdlog::debug("In DXYN x_start = {}, x_end = {}, y_start = {}, y_end = {}",
-                  x_start, x_end, y_start, y_end);
-    // TODO: More elegant solution for this?
-    // std::copy(std::cbegin(bitmap), std::cbegin(bitmap) + x_end,
-    // std::begin(row) + x_start);
-    /* std::for_each(std::begin(screen_) + y_start, std::begin(screen_) + y_end,
-     * fill_row); */
-    auto transform_row = [this, x_start, x_end,
-                          y_start](std::array<bool, SCREEN_WIDTH> &pixel_row,
-                                   u16 row) {
-        const auto byte = memory_[I_ + row - y_start];
-        spdlog::debug("In DXYN: loaded byte {:X} from memory", byte);
-        spdlog::debug("In DXYN: row = {}", row);
-        const auto bitmap = byte_to_bitmap(byte);
-        // XOR bitmap with pixel_row and set VF if a pixel_row bit is unset
-        for (auto col = x_start; col < x_end; ++col) {
-            // pixel_row bit becomes unset if both bits are true
-            if (bitmap[col - x_start] && pixel_row[col]) {
-                V_[0xF] = 0x1;
+    const auto x_start =
+        state_.V[nibble(nib::second, opcode)] % (SCREEN_WIDTH / scale) * scale;
+    const auto y_start =
+        state_.V[nibble(nib::third, opcode)] % (SCREEN_HEIGHT / scale) * scale;
+    auto sprite_height = nibble(nib::fourth, opcode);
+    const bool wide = Variant::HIRES && sprite_height == 0;
+    if (wide) {
+        sprite_height = 16;
+    }
+    const u32 sprite_bytes = wide ? 2 : 1;
+    // rows past the bottom of the screen are clipped, or wrap to the top
+    // with the WRAP_SPRITES quirk
+    const auto lines =
+        Quirks::WRAP_SPRITES
+            ? u32{sprite_height}
+            : std::min(static_cast<u32>(sprite_height),
+                       (SCREEN_HEIGHT - y_start) / scale);
+
+    CHIP8_TRACE(draw, "In DXYN x_start = {}, y_start = {}, lines = {}",
+                x_start, y_start, lines);
+
+    // each sprite row is moved to the top of a row word and shifted right to
+    // x_start, any bits past the last column fall off so the sprite is
+    // clipped, or are rotated back to the first column
+    const u32 shift = SCREEN_WIDTH - 8 * sprite_bytes * scale;
+    Row collisions = 0x0;
+    u32 address = state_.I;
+    for (auto plane = 0u; plane < PLANES; ++plane) {
+        if (!((selected_planes() >> plane) & 0x1u)) {
+            continue;
+        }
+        const auto rows = plane_rows(plane);
+        for (auto line = 0u; line < lines; ++line) {
+            Row bits = memory_[address + line * sprite_bytes];
+            if (wide) {
+                bits = (bits << 8) | memory_[address + line * 2 + 1];
             }
+            if (scale == 2) {
+                bits = double_bits(static_cast<u32>(bits));
+            }
+            const Row top = bits << shift;
+            auto sprite_row = top >> x_start;
+            if constexpr (Quirks::WRAP_SPRITES) {
+                if (x_start != 0) {
+                    sprite_row |= top << (SCREEN_WIDTH - x_start);
+                }
+            }
+            for (auto copy = 0u; copy < scale; ++copy) {
+                auto &row =
+                    rows[(y_start + line * scale + copy) % SCREEN_HEIGHT];
+                // a pixel is unset if it was set in both the screen and
+                // the sprite
+                collisions |= row & sprite_row;
+                row ^= sprite_row;
+            }
+        }
+        address += sprite_height * sprite_bytes;
+    }
+
+    state_.V[0xF] = collisions ? 0x1 : 0x0;
+    CHIP8_TRACE(draw, "Exiting DXYN");
+}
 
-            pixel_row[col] = (pixel_row[col] != bitmap[col - x_start]);
-            spdlog::debug("In DXYN: setting pixel_row[{}] to  {}", col,
-                          pixel_row[col]);
+// Skip the next instruction if the key in VX is held
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_EX9E(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In EX9E: X = {:x}", second_nibble);
+    if (key_held(state_.V[second_nibble])) {
+        skip();
+    }
+}
+
+// Skip the next instruction if the key in VX is not held
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_EXA1(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In EXA1: X = {:x}", second_nibble);
+    if (!key_held(state_.V[second_nibble])) {
+        skip();
+    }
+}
+
+// Store the current value of the delay timer in register VX
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FX07(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In FX07: X = {:x}", second_nibble);
+    state_.V[second_nibble] = state_.delay;
+}
+
+// Wait for a key, storing the lowest held key in register VX. Waiting
+// repeats the instruction so the timers keep running
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FX0A(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In FX0A: X = {:x}", second_nibble);
+    if (state_.keys == 0) {
+        state_.pc -= 2;
+        return;
+    }
+    state_.V[second_nibble] = static_cast<u8>(std::countr_zero(state_.keys));
+}
+
+// Set the delay timer to the value of register VX
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FX15(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In FX15: X = {:x}", second_nibble);
+    state_.delay = state_.V[second_nibble];
+}
+
+// Set the sound timer to the value of register VX
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FX18(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In FX18: X = {:x}", second_nibble);
+    state_.sound = state_.V[second_nibble];
+}
+
+// Store the binary coded decimal value of VX at I, I + 1 and I + 2
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FX33(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In FX33: X = {:x}", second_nibble);
+    const auto value = state_.V[second_nibble];
+    write_memory(state_.I, value / 100);
+    write_memory(state_.I + 1, (value / 10) % 10);
+    write_memory(state_.I + 2, value % 10);
+}
+
+// Store registers V0 to VX in memory starting at I, I is left unchanged
+// unless the LOAD_STORE_INCREMENT_I quirk moves it past VX
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FX55(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In FX55: X = {:x}", second_nibble);
+    for (auto reg = 0u; reg <= second_nibble; ++reg) {
+        write_memory(state_.I + reg, state_.V[reg]);
+    }
+    if constexpr (Quirks::LOAD_STORE_INCREMENT_I) {
+        state_.I += second_nibble + 1;
+    }
+}
+
+// Load registers V0 to VX from memory starting at I, I is left unchanged
+// unless the LOAD_STORE_INCREMENT_I quirk moves it past VX
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FX65(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(registers, "In FX65: X = {:x}", second_nibble);
+    for (auto reg = 0u; reg <= second_nibble; ++reg) {
+        state_.V[reg] = memory_[state_.I + reg];
+    }
+    if constexpr (Quirks::LOAD_STORE_INCREMENT_I) {
+        state_.I += second_nibble + 1;
+    }
+}
+
+// Scroll the selected bitplanes down by 0xN pixels
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00CN(
+    u16 opcode) noexcept {
+    CHIP8_TRACE(draw, "In 00CN: N = {:x}", opcode & 0x000F);
+    scroll_vertical(opcode & 0x000F);
+}
+
+// Scroll the selected bitplanes up by 0xN pixels
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00DN(
+    u16 opcode) noexcept {
+    CHIP8_TRACE(draw, "In 00DN: N = {:x}", opcode & 0x000F);
+    scroll_vertical(-(opcode & 0x000F));
+}
+
+// Scroll the selected bitplanes right by 4 pixels
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00FB(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(draw, "In 00FB");
+    scroll_horizontal(4);
+}
+
+// Scroll the selected bitplanes left by 4 pixels
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00FC(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(draw, "In 00FC");
+    scroll_horizontal(-4);
+}
+
+// Exit the interpreter, which repeats the instruction forever
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00FD(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(decode, "In 00FD");
+    state_.pc -= 2;
+}
+
+// Switch to lores, doubling every pixel, and clear the screen
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00FE(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(draw, "In 00FE");
+    if constexpr (Variant::HIRES) {
+        state_.display.hires = false;
+        std::ranges::fill(state_.screen, Row{0x0});
+    }
+}
+
+// Switch to hires, drawing at the full resolution, and clear the screen
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_00FF(
+    [[maybe_unused]] u16 opcode) noexcept {
+    CHIP8_TRACE(draw, "In 00FF");
+    if constexpr (Variant::HIRES) {
+        state_.display.hires = true;
+        std::ranges::fill(state_.screen, Row{0x0});
+    }
+}
+
+// Store registers VX to VY in memory starting at I, in reverse if X > Y.
+// I is left unchanged
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_5XY2(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    const auto third_nibble = nibble(nib::third, opcode);
+    CHIP8_TRACE(registers, "In 5XY2: X = {:x}, Y = {:x}", second_nibble,
+                third_nibble);
+    const int step = second_nibble <= third_nibble ? 1 : -1;
+    for (auto offset = 0u, reg = u32{second_nibble};; ++offset, reg += step) {
+        write_memory(state_.I + offset, state_.V[reg]);
+        if (reg == third_nibble) {
+            break;
         }
-    };
+    }
+}
 
-    // set VF to 0 before drawing sprite
-    V_[0xF] = 0x0;
-    const auto rows =
-        std::views::iota(static_cast<u16>(y_start), static_cast<u16>(y_end));
-    for (const auto row : rows) {
-        transform_row(screen_[row], row);
+// Load registers VX to VY from memory starting at I, in reverse if X > Y.
+// I is left unchanged
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_5XY3(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    const auto third_nibble = nibble(nib::third, opcode);
+    CHIP8_TRACE(registers, "In 5XY3: X = {:x}, Y = {:x}", second_nibble,
+                third_nibble);
+    const int step = second_nibble <= third_nibble ? 1 : -1;
+    for (auto offset = 0u, reg = u32{second_nibble};; ++offset, reg += step) {
+        state_.V[reg] = memory_[state_.I + offset];
+        if (reg == third_nibble) {
+            break;
+        }
     }
+}
+
+// Load I with the 16-bit address in the word after this one, and skip it
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_F000(
+    [[maybe_unused]] u16 opcode) noexcept {
+    state_.I = static_cast<u16>((memory_[state_.pc] << 8) +
+                                memory_[state_.pc + 1]);
+    CHIP8_TRACE(registers, "In F000: NNNN = {:x}", state_.I);
+    state_.pc += 2;
+}
 
-    spdlog::debug("Exiting DXYN");
+// Select the bitplanes in the bits of 0xN for drawing and scrolling
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+void inline Chip8Core<Variant, Quirks, MemoryModel>::_FN01(
+    u16 opcode) noexcept {
+    const auto second_nibble = nibble(nib::second, opcode);
+    CHIP8_TRACE(draw, "In FN01: N = {:x}", second_nibble);
+    if constexpr (Variant::HIRES) {
+        state_.display.planes = second_nibble & ((1u << PLANES) - 1);
+    }
 }
+
+template class Chip8Core<variant::Chip8>;
+template class Chip8Core<variant::Chip8, quirks::Cosmac>;
+template class Chip8Core<variant::Chip8, quirks::SuperChip>;
+template class Chip8Core<variant::Chip8, quirks::XoChip>;
+template class Chip8Core<variant::SuperChip>;
+template class Chip8Core<variant::XoChip>;
+template class Chip8Core<variant::Chip8, quirks::Modern, BasicPagedMemory>;
@@ -3,106 +3,395 @@
 #include <algorithm>
 #include <array>
 #include <bits/ranges_algo.h>
+#include <bitset>
 #include <cstdint>
+#include <memory>
 #include <ranges>
-#include <stack>
+#include <span>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 #include "spdlog/spdlog.h"
 
 #include "common.h"
+#include "decode.h"
+#include "flat_memory.h"
+#include "paged_memory.h"
+#include "profiler.h"
+#include "trace.h"
+#include "variant.h"
 
-class Chip8 {
+class Aot;
+struct AotProgram;
+class Jit;
+
+/// The state of a @tparam Variant machine. It lives outside Chip8Core so
+/// that cores which only differ in quirks or memory model save and load the
+/// same State.
+template <typename Variant> struct CoreState {
+    static constexpr u16 ROM_START = 0x200u;
+    static constexpr u8 STACK_SIZE = 16;
+
+    // the screen is packed one row per word, column 0 in the most
+    // significant bit, with the rows of each bitplane after the last
+    using Screen = std::array<typename Variant::Row,
+                              Variant::SCREEN_HEIGHT * Variant::PLANES>;
+
+    /// What SUPER-CHIP and XO-CHIP add to the machine.
+    struct Display {
+        // drawing at the full resolution instead of doubled pixels
+        bool hires = false;
+        // bit p is set while drawing and scrolling affect bitplane p
+        u8 planes = 0x1;
+
+        bool operator==(const Display &) const = default;
+    };
+    struct NoDisplay {
+        bool operator==(const NoDisplay &) const = default;
+    };
+
+    /// Everything but memory, which a core keeps in its memory model.
+    struct Machine {
+        Screen screen = {0x0};
+        // stack used for storing 16-bit return addresses, sp entries deep
+        std::array<u16, STACK_SIZE> stack = {0x0};
+        // general purpose registers
+        std::array<u8, 16> V = {0x0};
+        /// special registers
+        u16 pc = ROM_START;
+        u16 I = 0x0;
+        u8 sp = 0x0;
+        // timers
+        u8 sound = 0x0;
+        u8 delay = 0x0;
+        // keypad, bit k is set while key k is held
+        u16 keys = 0x0;
+        // set when the last instruction was not a valid opcode
+        bool bad_opcode = false;
+        // set on a call with a full stack or a return with an empty one
+        bool stack_fault = false;
+        // empty for CHIP-8, which always draws at full resolution
+        [[no_unique_address]] std::conditional_t<Variant::HIRES, Display,
+                                                 NoDisplay> display;
+
+        bool operator==(const Machine &) const = default;
+    };
+
+    /// The complete machine state. It is trivially copyable and holds no
+    /// pointers, so snapshots are a plain memcpy.
+    struct State : Machine {
+        // memory data
+        std::array<u8, Variant::MEMORY_SIZE> memory = {0x0};
+
+        bool operator==(const State &) const = default;
+    };
+    static_assert(std::is_trivially_copyable_v<State>);
+};
+
+/// The interpreter core, specialized at compile time for the machine
+/// described by @tparam Variant and the behaviors in @tparam Quirks, the
+/// variant's own unless given (see variant.h). Chip8, SuperChip and XoChip
+/// name the specializations with their own quirks.
+///
+/// Memory is held by @tparam MemoryModel, instantiated for the variant's
+/// memory size: FlatMemory, one inline array, unless given. SharedChip8
+/// uses BasicPagedMemory instead, sharing pages between instances until
+/// they are written.
+template <typename Variant, typename Quirks, template <u32> class MemoryModel>
+class Chip8Core {
   public:
     // constants
-    static constexpr u32 SCREEN_WIDTH = 64;
-    static constexpr u32 SCREEN_HEIGHT = 32;
-    static constexpr u16 ROM_START = 0x200u;
-    static constexpr u16 MEMORY_SIZE = 4096u;
+    static constexpr std::string_view VARIANT = Variant::NAME;
+    static constexpr std::string_view QUIRKS = Quirks::NAME;
+    static constexpr u32 SCREEN_WIDTH = Variant::SCREEN_WIDTH;
+    static constexpr u32 SCREEN_HEIGHT = Variant::SCREEN_HEIGHT;
+    static constexpr u32 PLANES = Variant::PLANES;
+    static constexpr u16 ROM_START = CoreState<Variant>::ROM_START;
+    static constexpr u32 MEMORY_SIZE = Variant::MEMORY_SIZE;
+    // largest ROM which fits in memory above ROM_START
+    static constexpr u32 MAX_ROM_SIZE = MEMORY_SIZE - ROM_START;
+
+    using Row = typename Variant::Row;
+    using Screen = typename CoreState<Variant>::Screen;
+    // unpacked first bitplane, one bool per pixel
+    using ScreenBitmap =
+        std::array<std::array<bool, SCREEN_WIDTH>, SCREEN_HEIGHT>;
+    static_assert(SCREEN_WIDTH == 8 * sizeof(Row),
+                  "a screen row must fill one Row");
+
+    using Memory = MemoryModel<MEMORY_SIZE>;
+    static_assert(MEMORY_SIZE == Memory::SIZE);
+
+    static constexpr u8 STACK_SIZE = CoreState<Variant>::STACK_SIZE;
 
-    Chip8() { initialize_font(); }
+    using Machine = typename CoreState<Variant>::Machine;
+    using State = typename CoreState<Variant>::State;
 
-    u8 V(u8 reg) const noexcept { return V_[reg]; }
-    u16 pc() const noexcept { return pc_; }
-    u16 I() const noexcept { return I_; }
-    const std::stack<u16> &stack() const noexcept { return stack_; }
-    const auto &screen() const noexcept { return screen_; }
-    const auto &memory() const noexcept { return memory_; }
-    u8 sound() const noexcept { return sound_; }
-    u8 delay() const noexcept { return delay_; }
-    bool bad_opcode() const noexcept { return bad_opcode_; }
+    /// how run() executes instructions
+    enum class Backend {
+        // fetch and decode every instruction
+        interpreter,
+        // execute basic blocks decoded once and cached by start address
+        block_cache,
+        // translate basic blocks to x86-64 code, interpreter elsewhere
+        jit,
+    };
+
+    Chip8Core();
+    ~Chip8Core();
+    Chip8Core(Chip8Core &&) noexcept;
+    Chip8Core &operator=(Chip8Core &&) noexcept;
 
-    void load_rom(const std::vector<u8> &rom) noexcept {
-        const auto end = std::min(std::cend(rom),
-                                  std::cbegin(rom) + MEMORY_SIZE - ROM_START);
-        std::copy(std::cbegin(rom), end, std::begin(memory_) + ROM_START);
+    u8 V(u8 reg) const noexcept { return state_.V[reg]; }
+    u16 pc() const noexcept { return state_.pc; }
+    u16 I() const noexcept { return state_.I; }
+    std::span<const u16> stack() const noexcept {
+        return {state_.stack.data(), state_.sp};
+    }
+    const auto &screen() const noexcept { return state_.screen; }
+    const Memory &memory() const noexcept { return memory_; }
+    u8 sound() const noexcept { return state_.sound; }
+    u8 delay() const noexcept { return state_.delay; }
+    u16 keys() const noexcept { return state_.keys; }
+    bool bad_opcode() const noexcept { return state_.bad_opcode; }
+    bool stack_fault() const noexcept { return state_.stack_fault; }
+
+    /// returns a copy of the complete machine state
+    State save_state() const noexcept {
+        auto state = State{};
+        static_cast<Machine &>(state) = state_;
+        memory_.copy_to(state.memory);
+        return state;
+    }
+    /// replaces the complete machine state with @param state. With paged
+    /// memory, pages which already hold the same bytes stay shared. A stack
+    /// pointer past the stack is clamped to it
+    void load_state(const State &state) noexcept {
+        state_ = state;
+        state_.sp = std::min(state_.sp, STACK_SIZE);
+        memory_.assign(state.memory);
+        flush_blocks();
+    }
+    /// returns to the power on state with just the font in memory. The
+    /// backend and the allocations behind it are kept, so this is much
+    /// cheaper than constructing a new instance
+    void reset() noexcept;
+
+    Backend backend() const noexcept { return backend_; }
+    /// selects the backend used by run(), selecting the jit on a host
+    /// without one selects the interpreter. The jit only translates CHIP-8,
+    /// the other variants get the block cache instead
+    void set_backend(Backend backend);
+
+    /// copies @param rom to ROM_START, anything past MAX_ROM_SIZE is cut off
+    void load_rom(std::span<const u8> rom) noexcept {
+        const auto size = std::min<std::size_t>(rom.size(), MAX_ROM_SIZE);
+        for (auto offset = 0u; offset < size; ++offset) {
+            memory_.write(ROM_START + offset, rom[offset]);
+        }
+        flush_blocks();
+    }
+
+    /// returns a memory image holding the font and @param rom, for
+    /// share_memory(). Anything past MAX_ROM_SIZE is cut off
+    static std::shared_ptr<const typename Memory::Image>
+    make_image(std::span<const u8> rom);
+    /// the image every instance starts out sharing, holding just the font
+    static const std::shared_ptr<const typename Memory::Image> &font_image();
+    /// replaces memory with @param image. Paged memory shares it read only
+    /// until written, so instances running the same ROM hold one copy, flat
+    /// memory copies it
+    void
+    share_memory(std::shared_ptr<const typename Memory::Image> image) noexcept {
+        memory_.share(std::move(image));
+        flush_blocks();
     }
 
     u16 fetch() noexcept {
         // opcodes stored in big endian
-        u8 upper_byte = memory_[pc_++];
-        u8 lower_byte = memory_[pc_++];
+        u8 upper_byte = memory_[state_.pc++];
+        u8 lower_byte = memory_[state_.pc++];
         u16 opcode = (upper_byte << 8) + lower_byte;
 
         return opcode;
     }
 
+    /// executes @param opcode through the dispatch table
     void execute(u16 opcode) noexcept;
+    /// executes @param opcode through a switch over decode(), kept as the
+    /// baseline the dispatch table is benchmarked against
+    void execute_switch(u16 opcode) noexcept;
 
     void cycle() noexcept {
         auto opcode = fetch();
-        spdlog::debug("opcode = {:x}", opcode);
+        CHIP8_TRACE(fetch, "opcode = {:x}", opcode);
+        if constexpr (profile::COMPILED) {
+            if (profiler_) {
+                profiler_->record(static_cast<u16>(state_.pc - 2), opcode,
+                                  stack());
+            }
+        }
         execute(opcode);
     }
 
-    bool screen_equal(const std::array<std::array<bool, SCREEN_WIDTH>,
-                                       SCREEN_HEIGHT> &other) const noexcept {
-        spdlog::debug("In screen_equal");
-        auto intermediate = std::views::iota(0u, SCREEN_HEIGHT) |
-                            std::views::transform([this, &other](u16 i) {
-                                return std::ranges::equal(screen_[i], other[i]);
-                            });
+    /// executes up to @param cycles instructions with the selected backend,
+    /// returns how many ran. Stops early if the pc runs off the end of memory
+    u32 run(u32 cycles) noexcept;
+
+    /// sets the held keys, bit k for key k. Called between frames, the
+    /// keypad only changes there
+    void set_keys(u16 keys) noexcept { state_.keys = keys; }
+
+    /// counts every instruction cycle() executes in @param profiler, made
+    /// with Profiler::for_variant<Variant>, nullptr detaches it. While one is
+    /// attached run() uses the interpreter whatever the backend. Does nothing
+    /// unless built with CHIP8_PROFILE
+    void set_profiler(Profiler *profiler) noexcept { profiler_ = profiler; }
+
+    /// runs the blocks of @param program, a ROM translated ahead of time by
+    /// chip8_recompile, wherever they are still intact in memory and the
+    /// interpreter elsewhere, whatever the backend. nullptr detaches it.
+    /// Programs are only translated for CHIP-8 with its default quirks
+    void set_program(const AotProgram *program);
+
+    /// with idle skipping on (the default) run() recognizes loops which only
+    /// wait for a timer tick or a key, jump to self, FX0A and delay timer
+    /// polling, and counts their remaining cycles as executed without
+    /// running them. The state is the same either way
+    void set_idle_skip(bool enabled) noexcept { idle_skip_ = enabled; }
+    /// cycles run() counted without executing them
+    u64 idle_cycles_skipped() const noexcept { return idle_cycles_skipped_; }
+    /// lets the block cache execute common sequences, ANNN then DXYN, runs
+    /// of 6XNN and 7XNN then 3XNN, as one superinstruction each. The state
+    /// is the same either way
+    void set_fusion(bool enabled) noexcept {
+        fusion_ = enabled;
+        flush_blocks();
+    }
+
+    /// decrements the delay and sound timers, called at 60 Hz
+    void tick_timers() noexcept {
+        if (state_.delay > 0) {
+            --state_.delay;
+        }
+        if (state_.sound > 0) {
+            --state_.sound;
+        }
+    }
+
+    bool screen_equal(const Screen &other) const noexcept {
+        return state_.screen == other;
+    }
 
-        spdlog::debug("In screen_equal: finished intermediate");
-        return std::ranges::all_of(std::cbegin(intermediate),
-                                   std::cend(intermediate),
-                                   [](bool b) { return b; });
+    bool screen_equal(const ScreenBitmap &other) const noexcept {
+        return screen_equal(pack_screen(other));
     }
 
     void set_debug_level(spdlog::level::level_enum level) {
         spdlog::set_level(level);
     }
 
-    auto screen_difference(
-        const std::array<std::array<bool, SCREEN_WIDTH>, SCREEN_HEIGHT> &other)
-        const noexcept {
-        auto differences =
-            std::array<std::array<bool, SCREEN_WIDTH>, SCREEN_HEIGHT>{};
-        auto compute_xor = [](const std::array<bool, SCREEN_WIDTH> &row1,
-                              const std::array<bool, SCREEN_WIDTH> &row2) {
-            auto xored = std::array<bool, SCREEN_WIDTH>{};
-            std::ranges::transform(row1, row2, std::begin(xored),
-                                   [](bool b1, bool b2) { return b1 != b2; });
+    /// returns a screen with a pixel set wherever the screen and @param other
+    /// differ
+    Screen screen_difference(const Screen &other) const noexcept {
+        auto differences = Screen{};
+        std::ranges::transform(state_.screen, other, std::begin(differences),
+                               [](Row row1, Row row2) { return row1 ^ row2; });
 
-            return xored;
-        };
+        return differences;
+    }
 
-        std::ranges::transform(screen_, other, std::begin(differences),
-                               compute_xor);
+    Screen screen_difference(const ScreenBitmap &other) const noexcept {
+        return screen_difference(pack_screen(other));
+    }
 
-        return differences;
+    /// returns a hash of the packed screen contents
+    u64 screen_hash() const noexcept {
+        return fnv1a({reinterpret_cast<const u8 *>(state_.screen.data()),
+                      sizeof(state_.screen)});
+    }
+
+    /// returns the pixel at @param row, @param col of the first bitplane of
+    /// a packed screen
+    static constexpr bool pixel(const Screen &screen, u32 row,
+                                u32 col) noexcept {
+        return (screen[row] >> (SCREEN_WIDTH - 1 - col)) & 0x1u;
+    }
+
+    /// packs a bool per pixel bitmap into the first bitplane of a Screen
+    static constexpr Screen pack_screen(const ScreenBitmap &bitmap) noexcept {
+        auto packed = Screen{};
+        for (auto row = 0u; row < SCREEN_HEIGHT; ++row) {
+            for (auto col = 0u; col < SCREEN_WIDTH; ++col) {
+                if (bitmap[row][col]) {
+                    packed[row] |= Row{1} << (SCREEN_WIDTH - 1 - col);
+                }
+            }
+        }
+        return packed;
     }
 
   private:
-    /// special registers
-    u16 pc_ = ROM_START;
-    u16 I_ = 0x0;
+    friend class Aot;
+    friend class Jit;
+    friend class Lockstep;
+
+    Machine state_;
+    Memory memory_;
+
+    // a handler with the register fields of its opcode baked in
+    using Dispatch = void (*)(Chip8Core &, u16) noexcept;
+
+    // the specialized handler for every opcode, generated at compile time
+    static const std::array<Dispatch, 0x10000> DISPATCH_TABLE;
+    static constexpr std::array<Dispatch, 0x10000>
+    make_dispatch_table() noexcept;
+    static constexpr Dispatch dispatch_entry(u16 opcode) noexcept;
 
-    // general purpose registers
-    std::array<u8, 16> V_ = {0x0};
+    // basic block cache
+    static constexpr u32 MAX_BLOCK_LENGTH = 64;
+    static constexpr u32 MAX_FUSED_LENGTH = 8;
+    struct DecodedOp;
+    // executes @param ops[0] to ops[ops->length - 1] with the pc already
+    // past all of them
+    using Fused = void (*)(Chip8Core &, const DecodedOp *ops) noexcept;
+    struct DecodedOp {
+        Dispatch handler;
+        u16 opcode;
+        // set on the first instruction of a superinstruction
+        Fused fused = nullptr;
+        // instructions fused, 1 if not fused
+        u8 length = 1;
+    };
+    struct Block {
+        u16 start = 0x0;
+        // one past the last byte of the block
+        u16 end = 0x0;
+        std::vector<DecodedOp> ops;
+    };
+    struct BlockCache {
+        std::vector<Block> blocks;
+        // 1 + index into blocks of the block starting at an address, 0 if
+        // there is none
+        std::array<u16, MEMORY_SIZE> block_at = {0x0};
+        // addresses covered by a cached block
+        std::bitset<MEMORY_SIZE> code;
+        // bumped on every flush so running blocks notice
+        u32 generation = 0;
+    };
 
-    // memory data
-    std::array<u8, MEMORY_SIZE> memory_ = {0x0}; // 4K memory
+    Backend backend_ = Backend::interpreter;
+    bool idle_skip_ = true;
+    bool fusion_ = true;
+    Profiler *profiler_ = nullptr;
+    u64 idle_cycles_skipped_ = 0;
+    // only allocated once the block cache backend is selected
+    std::unique_ptr<BlockCache> block_cache_;
+    // only allocated once the jit backend is selected
+    std::unique_ptr<Jit> jit_;
+    // runs the program attached with set_program
+    std::unique_ptr<Aot> aot_;
 
     // font data
     static constexpr u16 FONT_START = 0x50u;
@@ -125,43 +414,133 @@ class Chip8 {
         0xF0, 0x80, 0xF0, 0x80, 0x80  // F
     };
 
-    // screen
-    std::array<std::array<bool, SCREEN_WIDTH>, SCREEN_HEIGHT> screen_ = {
-        std::array<bool, SCREEN_WIDTH>{false}};
-
-    // stack
-    // used for storing 16-bit addresses
-    std::stack<u16> stack_;
+    // the jit and chip8_recompile translate CHIP-8 with its default quirks
+    // only
+    static constexpr bool JIT = std::is_same_v<Chip8Core, ::Chip8>;
 
-    // timers
-    u8 sound_ = 0x0;
-    u8 delay_ = 0x0;
     // internal operations
+    // drawing at the full resolution, CHIP-8 always is
+    bool hires() const noexcept {
+        if constexpr (Variant::HIRES) {
+            return state_.display.hires;
+        }
+        return true;
+    }
+    // the bitplanes drawing and scrolling affect
+    u8 selected_planes() const noexcept {
+        if constexpr (Variant::HIRES) {
+            return state_.display.planes;
+        }
+        return 0x1;
+    }
+    // the rows of bitplane @param plane
+    std::span<Row, SCREEN_HEIGHT> plane_rows(u32 plane) noexcept {
+        return std::span<Row, SCREEN_HEIGHT>{
+            state_.screen.data() + plane * SCREEN_HEIGHT, SCREEN_HEIGHT};
+    }
     void clear_screen() noexcept {
-        std::ranges::fill(screen_, std::array<bool, SCREEN_WIDTH>{false});
+        for (auto plane = 0u; plane < PLANES; ++plane) {
+            if ((selected_planes() >> plane) & 0x1u) {
+                std::ranges::fill(plane_rows(plane), Row{0x0});
+            }
+        }
+    }
+    // skips the next instruction, both words of an XO-CHIP F000 NNNN
+    void skip() noexcept {
+        if constexpr (Variant::LONG_LOAD) {
+            if (memory_[state_.pc] == 0xF0 && memory_[state_.pc + 1] == 0x00) {
+                state_.pc += 2;
+            }
+        }
+        state_.pc += 2;
     }
-    void clear_bad_opcode() noexcept { bad_opcode_ = false; }
-    void initialize_font() noexcept {
-        std::copy(std::cbegin(FONT), std::cend(FONT),
-                  std::begin(memory_) + FONT_START);
+    // scrolls the selected bitplanes by @param rows down, negative is up
+    void scroll_vertical(int rows) noexcept;
+    // scrolls the selected bitplanes by @param columns right, negative is
+    // left
+    void scroll_horizontal(int columns) noexcept;
+    void clear_bad_opcode() noexcept { state_.bad_opcode = false; }
+    bool key_held(u8 key) const noexcept {
+        return (state_.keys >> (key & 0xF)) & 0x1u;
     }
+    // all stores from instructions go through here so writes into cached
+    // or translated code flush it
+    void write_memory(u16 address, u8 value) noexcept {
+        address %= MEMORY_SIZE;
+        memory_.write(address, value);
+        if ((block_cache_ && block_cache_->code.test(address)) ||
+            translated(address)) {
+            flush_blocks();
+        }
+    }
+    bool translated(u16 address) const noexcept;
+    void flush_blocks() noexcept;
+    const Block &build_block(u16 start);
+    void fuse(Block &block) const noexcept;
+    static void fused_draw(Chip8Core &chip8, const DecodedOp *ops) noexcept;
+    static void fused_loads(Chip8Core &chip8, const DecodedOp *ops) noexcept;
+    static void fused_add_skip(Chip8Core &chip8,
+                               const DecodedOp *ops) noexcept;
+    u32 run_blocks(u32 cycles) noexcept;
+    bool profiling() const noexcept {
+        return profile::COMPILED && profiler_ != nullptr;
+    }
+    u32 idle_loop_length() const noexcept;
+    // returns how many of @param remaining cycles were skipped in an idle
+    // loop at the pc
+    u32 skip_idle(u32 remaining) noexcept;
 
     /// instructions
+    void inline _NOOP([[maybe_unused]] u16 opcode) noexcept;
+    void inline _UNKNOWN([[maybe_unused]] u16 opcode) noexcept;
     void inline _0NNN([[maybe_unused]] u16 opcode) noexcept;
     void inline _00E0([[maybe_unused]] u16 opcode) noexcept;
     void inline _00EE([[maybe_unused]] u16 opcode) noexcept;
     void inline _1NNN(u16 opcode) noexcept;
     void inline _2NNN(u16 opcode) noexcept;
+    void inline _3XNN(u16 opcode) noexcept;
+    void inline _4XNN(u16 opcode) noexcept;
     void inline _6XNN(u16 opcode) noexcept;
     void inline _7XNN(u16 opcode) noexcept;
     void inline _8XY0(u16 opcode) noexcept;
     void inline _8XY1(u16 opcode) noexcept;
     void inline _8XY2(u16 opcode) noexcept;
     void inline _8XY3(u16 opcode) noexcept;
+    void inline _8XY6(u16 opcode) noexcept;
+    void inline _8XYE(u16 opcode) noexcept;
 
     void inline _ANNN(u16 opcode) noexcept;
+    void inline _BNNN(u16 opcode) noexcept;
     void inline _DXYN(u16 opcode) noexcept;
+    void inline _EX9E(u16 opcode) noexcept;
+    void inline _EXA1(u16 opcode) noexcept;
+    void inline _FX07(u16 opcode) noexcept;
+    void inline _FX0A(u16 opcode) noexcept;
+    void inline _FX15(u16 opcode) noexcept;
+    void inline _FX18(u16 opcode) noexcept;
+    void inline _FX33(u16 opcode) noexcept;
+    void inline _FX55(u16 opcode) noexcept;
+    void inline _FX65(u16 opcode) noexcept;
 
-    // bad instruction flag
-    bool bad_opcode_ = false;
+    // SUPER-CHIP and XO-CHIP
+    void inline _00CN(u16 opcode) noexcept;
+    void inline _00DN(u16 opcode) noexcept;
+    void inline _00FB([[maybe_unused]] u16 opcode) noexcept;
+    void inline _00FC([[maybe_unused]] u16 opcode) noexcept;
+    void inline _00FD([[maybe_unused]] u16 opcode) noexcept;
+    void inline _00FE([[maybe_unused]] u16 opcode) noexcept;
+    void inline _00FF([[maybe_unused]] u16 opcode) noexcept;
+    void inline _5XY2(u16 opcode) noexcept;
+    void inline _5XY3(u16 opcode) noexcept;
+    void inline _F000([[maybe_unused]] u16 opcode) noexcept;
+    void inline _FN01(u16 opcode) noexcept;
 };
+
+extern template class Chip8Core<variant::Chip8>;
+extern template class Chip8Core<variant::Chip8, quirks::Cosmac>;
+extern template class Chip8Core<variant::Chip8, quirks::SuperChip>;
+extern template class Chip8Core<variant::Chip8, quirks::XoChip>;
+extern template class Chip8Core<variant::SuperChip>;
+extern template class Chip8Core<variant::XoChip>;
+extern template class Chip8Core<variant::Chip8, quirks::Modern,
+                                BasicPagedMemory>;
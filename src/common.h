@@ -3,15 +3,19 @@
 #include <array>
 #include <cstdint>
 #include <ranges>
+#include <span>
 
 using u8 = std::uint8_t;
 using u16 = std::uint16_t;
 using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+// a GCC and Clang extension, one row of a 128 pixel wide screen
+__extension__ using u128 = unsigned __int128;
 
 enum class nib { first, second, third, fourth };
 
 /// returns the @param which nibble of @param what
-inline u16 nibble(nib which, u16 what) {
+constexpr u16 nibble(nib which, u16 what) {
     switch (which) {
     case nib::first:
         return (0xF000 & what) >> (4 * 3); // shift down by 3 half-bytes
@@ -40,3 +44,13 @@ inline std::array<bool, 8> byte_to_bitmap(u8 byte) {
               std::begin(to_return));
     return to_return;
 }
+
+/// 64-bit FNV-1a hash of @param bytes
+inline u64 fnv1a(std::span<const u8> bytes) {
+    u64 hash = 0xcbf29ce484222325;
+    for (const auto byte : bytes) {
+        hash ^= byte;
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
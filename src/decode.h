@@ -0,0 +1,254 @@
+#pragma once
+
+#include <string_view>
+
+#include "common.h"
+
+/// Every CHIP-8, SUPER-CHIP and XO-CHIP instruction, named after its opcode
+/// pattern like the Chip8 handlers. unknown covers the opcodes that are not
+/// instructions.
+enum class Op : u8 {
+    _0NNN,
+    _00E0,
+    _00EE,
+    _1NNN,
+    _2NNN,
+    _3XNN,
+    _4XNN,
+    _5XY0,
+    _6XNN,
+    _7XNN,
+    _8XY0,
+    _8XY1,
+    _8XY2,
+    _8XY3,
+    _8XY4,
+    _8XY5,
+    _8XY6,
+    _8XY7,
+    _8XYE,
+    _9XY0,
+    _ANNN,
+    _BNNN,
+    _CXNN,
+    _DXYN,
+    _EX9E,
+    _EXA1,
+    _FX07,
+    _FX0A,
+    _FX15,
+    _FX18,
+    _FX1E,
+    _FX29,
+    _FX33,
+    _FX55,
+    _FX65,
+    // SUPER-CHIP
+    _00CN,
+    _00FB,
+    _00FC,
+    _00FD,
+    _00FE,
+    _00FF,
+    _FX30,
+    _FX75,
+    _FX85,
+    // XO-CHIP
+    _00DN,
+    _5XY2,
+    _5XY3,
+    _F000,
+    _FN01,
+    _F002,
+    _FX3A,
+    unknown,
+};
+
+inline constexpr u32 OP_COUNT = static_cast<u32>(Op::unknown) + 1;
+
+/// returns the instruction @param opcode encodes
+constexpr Op decode(u16 opcode) noexcept {
+    switch (nibble(nib::first, opcode)) {
+    case 0x0:
+        if (opcode == 0x00E0) {
+            return Op::_00E0;
+        }
+        if (opcode == 0x00EE) {
+            return Op::_00EE;
+        }
+        return Op::_0NNN;
+    case 0x1:
+        return Op::_1NNN;
+    case 0x2:
+        return Op::_2NNN;
+    case 0x3:
+        return Op::_3XNN;
+    case 0x4:
+        return Op::_4XNN;
+    case 0x5:
+        return nibble(nib::fourth, opcode) == 0x0 ? Op::_5XY0 : Op::unknown;
+    case 0x6:
+        return Op::_6XNN;
+    case 0x7:
+        return Op::_7XNN;
+    case 0x8:
+        switch (nibble(nib::fourth, opcode)) {
+        case 0x0:
+            return Op::_8XY0;
+        case 0x1:
+            return Op::_8XY1;
+        case 0x2:
+            return Op::_8XY2;
+        case 0x3:
+            return Op::_8XY3;
+        case 0x4:
+            return Op::_8XY4;
+        case 0x5:
+            return Op::_8XY5;
+        case 0x6:
+            return Op::_8XY6;
+        case 0x7:
+            return Op::_8XY7;
+        case 0xE:
+            return Op::_8XYE;
+        }
+        return Op::unknown;
+    case 0x9:
+        return nibble(nib::fourth, opcode) == 0x0 ? Op::_9XY0 : Op::unknown;
+    case 0xA:
+        return Op::_ANNN;
+    case 0xB:
+        return Op::_BNNN;
+    case 0xC:
+        return Op::_CXNN;
+    case 0xD:
+        return Op::_DXYN;
+    case 0xE:
+        switch (opcode & 0x00FF) {
+        case 0x9E:
+            return Op::_EX9E;
+        case 0xA1:
+            return Op::_EXA1;
+        }
+        return Op::unknown;
+    case 0xF:
+        switch (opcode & 0x00FF) {
+        case 0x07:
+            return Op::_FX07;
+        case 0x0A:
+            return Op::_FX0A;
+        case 0x15:
+            return Op::_FX15;
+        case 0x18:
+            return Op::_FX18;
+        case 0x1E:
+            return Op::_FX1E;
+        case 0x29:
+            return Op::_FX29;
+        case 0x33:
+            return Op::_FX33;
+        case 0x55:
+            return Op::_FX55;
+        case 0x65:
+            return Op::_FX65;
+        }
+        return Op::unknown;
+    }
+    return Op::unknown;
+}
+
+/// returns the SUPER-CHIP instruction @param opcode encodes
+constexpr Op decode_superchip(u16 opcode) noexcept {
+    if ((opcode & 0xFFF0) == 0x00C0) {
+        return Op::_00CN;
+    }
+    switch (opcode) {
+    case 0x00FB:
+        return Op::_00FB;
+    case 0x00FC:
+        return Op::_00FC;
+    case 0x00FD:
+        return Op::_00FD;
+    case 0x00FE:
+        return Op::_00FE;
+    case 0x00FF:
+        return Op::_00FF;
+    }
+    if (nibble(nib::first, opcode) == 0xF) {
+        switch (opcode & 0x00FF) {
+        case 0x30:
+            return Op::_FX30;
+        case 0x75:
+            return Op::_FX75;
+        case 0x85:
+            return Op::_FX85;
+        }
+    }
+    return decode(opcode);
+}
+
+/// returns the XO-CHIP instruction @param opcode encodes
+constexpr Op decode_xochip(u16 opcode) noexcept {
+    if ((opcode & 0xFFF0) == 0x00D0) {
+        return Op::_00DN;
+    }
+    if (nibble(nib::first, opcode) == 0x5) {
+        switch (nibble(nib::fourth, opcode)) {
+        case 0x2:
+            return Op::_5XY2;
+        case 0x3:
+            return Op::_5XY3;
+        }
+    }
+    if (opcode == 0xF000) {
+        return Op::_F000;
+    }
+    if (opcode == 0xF002) {
+        return Op::_F002;
+    }
+    if ((opcode & 0xF0FF) == 0xF001) {
+        return Op::_FN01;
+    }
+    if ((opcode & 0xF0FF) == 0xF03A) {
+        return Op::_FX3A;
+    }
+    return decode_superchip(opcode);
+}
+
+/// true if @param op can move the pc anywhere other than the next
+/// instruction, so a basic block ends after it
+constexpr bool ends_block(Op op) noexcept {
+    switch (op) {
+    case Op::_00EE:
+    case Op::_1NNN:
+    case Op::_2NNN:
+    case Op::_3XNN:
+    case Op::_4XNN:
+    case Op::_5XY0:
+    case Op::_9XY0:
+    case Op::_BNNN:
+    case Op::_EX9E:
+    case Op::_EXA1:
+    case Op::_FX0A:
+    case Op::_00FD:
+    case Op::_F000:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/// the opcode pattern of @param op, e.g. "6XNN"
+constexpr std::string_view op_name(Op op) noexcept {
+    constexpr std::string_view names[] = {
+        "0NNN", "00E0", "00EE", "1NNN", "2NNN", "3XNN", "4XNN", "5XY0",
+        "6XNN", "7XNN", "8XY0", "8XY1", "8XY2", "8XY3", "8XY4", "8XY5",
+        "8XY6", "8XY7", "8XYE", "9XY0", "ANNN", "BNNN", "CXNN", "DXYN",
+        "EX9E", "EXA1", "FX07", "FX0A", "FX15", "FX18", "FX1E", "FX29",
+        "FX33", "FX55", "FX65", "00CN", "00FB", "00FC", "00FD", "00FE",
+        "00FF", "FX30", "FX75", "FX85", "00DN", "5XY2", "5XY3", "F000",
+        "FN01", "F002", "FX3A", "????",
+    };
+    static_assert(std::size(names) == OP_COUNT);
+    return names[static_cast<u32>(op)];
+}
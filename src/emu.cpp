@@ -1,7 +1,20 @@
 #include "emu.h"
+#include "sdl_audio_sink.h"
 #include <SDL_render.h>
 
-u32 Emu::init_SDL() {
+template <typename Core>
+typename ScreenRenderer<Core>::Palette Emu<Core>::palette() noexcept {
+    auto colors = typename ScreenRenderer<Core>::Palette{};
+    colors[0] = {background_red, background_green, background_blue};
+    colors[1] = {pixel_red, pixel_green, pixel_blue};
+    if constexpr (Core::PLANES > 1) {
+        colors[2] = {plane2_red, plane2_green, plane2_blue};
+        colors[3] = {both_red, both_green, both_blue};
+    }
+    return colors;
+}
+
+template <typename Core> u32 Emu<Core>::init_SDL() {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         spdlog::error("Could not initialize SDL\nError: %s\n", SDL_GetError());
         return 10;
@@ -23,74 +36,107 @@ u32 Emu::init_SDL() {
                       SDL_GetError());
         return 30;
     }
+    if (screen_renderer_.init(renderer_) != 0) {
+        return 40;
+    }
 
     return 0;
 }
-Emu::Emu(u8 screen_scale, State state)
-    : screen_scale_{screen_scale}, state_{state},
+
+// plays the beep through SDL, or nowhere if there is no audio device
+template <typename Core>
+void Emu<Core>::init_audio() {
+    audio_sink_ = std::make_unique<SdlAudioSink>();
+    if (audio_sink_->start(audio_) == 0) {
+        return;
+    }
+    spdlog::warn("Running without sound");
+    audio_sink_ = std::make_unique<NullAudioSink>();
+    audio_sink_->start(audio_);
+}
+
+template <typename Core>
+Emu<Core>::Emu(u8 screen_scale, State state, AudioConfig audio)
+    : screen_renderer_{palette()}, screen_scale_{screen_scale},
+      state_{state},
       screen_width_{chip8_.SCREEN_WIDTH * screen_scale},
-      screen_height_{chip8_.SCREEN_HEIGHT * screen_scale} {
+      screen_height_{chip8_.SCREEN_HEIGHT * screen_scale},
+      pacer_{frames_per_second_}, audio_{audio} {
+    chip8_.set_backend(Core::Backend::block_cache);
     u32 ec = init_SDL();
     // terminate if SDL does not load correctly
     if (ec != 0) {
         std::abort();
     }
+    init_audio();
 }
 
-Emu::~Emu() {
+template <typename Core>
+Emu<Core>::~Emu() {
+    if (emulation_.joinable()) {
+        running_ = false;
+        signal_control();
+        emulation_.join();
+    }
+    audio_sink_->stop();
+    // the texture has to go before the renderer that owns it
+    screen_renderer_.destroy();
     SDL_DestroyRenderer(renderer_);
     SDL_DestroyWindow(window_);
     SDL_Quit();
 }
 
-void Emu::render() {
-    SDL_RenderClear(renderer_);
-    const auto &screen = chip8_.screen();
-    SDL_SetRenderDrawColor(renderer_, background_red, background_green,
-                           background_blue, 0);
-    SDL_RenderFillRect(renderer_, nullptr);
-
-    auto rows = std::views::iota(0u, chip8_.SCREEN_HEIGHT);
-    auto cols = std::views::iota(0u, chip8_.SCREEN_WIDTH);
-
-    SDL_SetRenderDrawColor(renderer_, pixel_red, pixel_green, pixel_blue, 0);
-    for (const auto row : rows) {
-        for (const auto col : cols) {
-            if (screen[row][col]) {
-                SDL_Rect rect = {.x = static_cast<int>(col * screen_scale_),
-                                 .y = static_cast<int>(row * screen_scale_),
-                                 .w = screen_scale_,
-                                 .h = screen_scale_};
-                SDL_RenderFillRect(renderer_, &rect);
-            }
-        }
-    }
+template <typename Core>
+void Emu<Core>::render() {
+    const auto start = FramePacer::clock::now();
+    screen_renderer_.render(frames_.read_buffer());
+    const auto elapsed = FramePacer::clock::now() - start;
 
-    SDL_RenderPresent(renderer_);
+    ++render_stats_.frames;
+    render_stats_.total_time += elapsed;
+    render_stats_.max_time = std::max<std::chrono::nanoseconds>(
+        render_stats_.max_time, elapsed);
 }
 
-void Emu::step() {
+template <typename Core>
+void Emu<Core>::step() {
     auto opcode = chip8_.fetch();
-    spdlog::debug("opcode = {:x}", opcode);
+    CHIP8_TRACE(fetch, "opcode = {:x}", opcode);
     chip8_.execute(opcode);
-    render();
+    publish_frame();
 }
 
-void Emu::cycle_forward(u8 cycles_remaining) {
-    const auto cycles = std::views::iota(0u, cycles_remaining);
-    for (const auto c : cycles) {
-        chip8_.cycle();
-    }
+template <typename Core>
+void Emu<Core>::cycle_forward(u32 cycles) { chip8_.run(cycles); }
+
+template <typename Core>
+void Emu<Core>::signal_control() noexcept {
+    control_.fetch_add(1);
+    control_.notify_one();
 }
 
 /// return the number of chip8 instructions executed
-u8 Emu::handle_event(const SDL_Event &event) {
+template <typename Core>
+u8 Emu<Core>::handle_event(const SDL_Event &event) {
     u8 instructions_executed = 0;
 
     switch (event.type) {
     case SDL_QUIT:
         spdlog::debug("Received SDL_QUIT, exiting.");
         running_ = false;
+        signal_control();
+        break;
+
+    case SDL_RENDER_TARGETS_RESET:
+        spdlog::debug("Render targets reset, reuploading the screen");
+        screen_renderer_.invalidate();
+        break;
+
+    case SDL_RENDER_DEVICE_RESET:
+        // the device took every texture with it
+        spdlog::debug("Render device reset, recreating the screen texture");
+        screen_renderer_.destroy();
+        screen_renderer_.init(renderer_);
         break;
 
     case SDL_KEYDOWN:
@@ -98,14 +144,20 @@ u8 Emu::handle_event(const SDL_Event &event) {
 
         if (chip8_paused_ && keys[SDL_SCANCODE_N] == 1) {
             spdlog::debug("Keydown event: N");
-            chip8_.cycle();
+            ++step_requests_;
+            signal_control();
             instructions_executed++;
         } else if (chip8_paused_ && keys[SDL_SCANCODE_R] == 1) {
             spdlog::debug("Keydown event: R");
             chip8_paused_ = false;
+            signal_control();
         } else if (keys[SDL_SCANCODE_P] == 1) {
             spdlog::debug("Keydown event: P");
             chip8_paused_ = true;
+            signal_control();
+        } else if (keys[SDL_SCANCODE_TAB] == 1) {
+            spdlog::debug("Keydown event: Tab, turbo {}", !turbo_);
+            turbo_ = !turbo_;
         }
         break;
     }
@@ -113,69 +165,259 @@ u8 Emu::handle_event(const SDL_Event &event) {
     return instructions_executed;
 }
 
-void Emu::run() {
-    u8 instructions_executed = 0;
-    u8 frames_rendered = 0;
-    u32 last_time = 0;
-    u32 current_time = 0;
+template <typename Core>
+void Emu<Core>::run_frame() {
+    auto keys = keys_.load(std::memory_order_relaxed);
+    if (movie_mode_ == MovieMode::replay) {
+        if (movie_frame_ < movie_.frames()) {
+            keys = movie_.keys[movie_frame_++];
+        } else {
+            spdlog::info("Movie ended after {} frames", movie_frame_);
+            movie_mode_ = MovieMode::none;
+        }
+    } else if (movie_mode_ == MovieMode::record) {
+        movie_.keys.push_back(keys);
+    }
+    ::run_frame(chip8_, keys, instructions_per_frame_);
+    audio_.report_sound_timer(chip8_.sound());
+}
+
+template <typename Core>
+u16 Emu<Core>::read_keypad() const noexcept {
+    const auto *state = SDL_GetKeyboardState(nullptr);
+    u16 keys = 0x0;
+    for (auto key = 0u; key < KEYPAD.size(); ++key) {
+        if (state[KEYPAD[key]]) {
+            keys |= 1u << key;
+        }
+    }
+    return keys;
+}
+
+template <typename Core>
+void Emu<Core>::publish_frame() {
+    frames_.write_buffer() = chip8_.screen();
+    frames_.publish();
+}
+
+template <typename Core>
+typename Emu<Core>::EmulationStats Emu<Core>::emulation_stats() const {
+    std::scoped_lock lock{stats_mutex_};
+    return last_emulation_stats_;
+}
+
+template <typename Core>
+typename Emu<Core>::RenderStats Emu<Core>::render_stats() const {
+    std::scoped_lock lock{stats_mutex_};
+    return last_render_stats_;
+}
+
+template <typename Core>
+void Emu<Core>::report_emulation_timing() {
+    using namespace std::chrono;
+    auto stats = EmulationStats{};
+    stats.pacer = pacer_.take_stats();
+    stats.turbo_frames = turbo_frames_;
+    const auto frames = std::max<u64>(stats.pacer.ticks + turbo_frames_, 1);
+    stats.time_per_frame = emulation_time_ / frames;
+    stats.published = frames_.published();
+    stats.overwritten = frames_.overwritten();
+    {
+        std::scoped_lock lock{stats_mutex_};
+        last_emulation_stats_ = stats;
+    }
+
+    spdlog::debug("Frames over last second = {}, dropped = {}",
+                  stats.pacer.ticks, stats.pacer.dropped_ticks);
+    spdlog::debug(
+        "Frame drift: average = {} us, max = {} us",
+        duration_cast<microseconds>(stats.pacer.average_lateness()).count(),
+        duration_cast<microseconds>(stats.pacer.max_lateness).count());
+    if (stats.turbo_frames > 0) {
+        spdlog::debug("Turbo frames over last second = {}",
+                      stats.turbo_frames);
+    }
+    spdlog::debug("Emulation: {} ns per frame, {} frames published, {} never "
+                  "rendered",
+                  stats.time_per_frame.count(), stats.published,
+                  stats.overwritten);
+    const auto audio = audio_.take_stats();
+    spdlog::debug("Audio: {} buffers, latency average = {} us, max = {} us, "
+                  "{} changes dropped",
+                  audio.buffers,
+                  duration_cast<microseconds>(audio.average_latency()).count(),
+                  duration_cast<microseconds>(audio.max_latency).count(),
+                  audio.dropped_changes);
+    emulation_time_ = nanoseconds{0};
+    turbo_frames_ = 0;
+}
+
+template <typename Core>
+void Emu<Core>::report_render_timing() {
+    using namespace std::chrono;
+    const auto frames = std::max<u64>(render_stats_.frames, 1);
+    spdlog::debug(
+        "Render: {} frames presented, average = {} us, max = {} us",
+        render_stats_.frames,
+        duration_cast<microseconds>(render_stats_.total_time).count() / frames,
+        duration_cast<microseconds>(render_stats_.max_time).count());
+    {
+        std::scoped_lock lock{stats_mutex_};
+        last_render_stats_ = render_stats_;
+    }
+    render_stats_ = RenderStats{};
+}
+
+// body of the emulation thread
+template <typename Core>
+void Emu<Core>::emulate() {
+    using namespace std::chrono;
+    auto last_report = FramePacer::clock::now();
+    pacer_.start(last_report);
 
     while (running_) {
-        while (SDL_PollEvent(&event_) > 0) {
-            instructions_executed += handle_event(event_);
+        // read first so a change made after the checks below ends the wait
+        const auto control = control_.load();
+        if (chip8_paused_) {
+            if (step_requests_ > 0) {
+                --step_requests_;
+                // a movie only holds whole frames
+                if (movie_mode_ == MovieMode::none) {
+                    step();
+                }
+                continue;
+            }
+            // nothing runs while paused, so silence the beep and block until
+            // the next change
+            audio_.report_sound_timer(0);
+            control_.wait(control);
+            // don't try to catch up on the time spent paused
+            pacer_.start(FramePacer::clock::now());
+            continue;
         }
 
-        if (instructions_executed == 10) {
-            instructions_executed = 0;
-            render();
-            frames_rendered++;
+        if (turbo_) {
+            // uncapped, only the frames frame_skip_ picks are shown
+            const auto start = FramePacer::clock::now();
+            run_frame();
+            const auto now = FramePacer::clock::now();
+            if (frame_skip_.show(now)) {
+                publish_frame();
+            }
+            emulation_time_ += now - start;
+            ++turbo_frames_;
+            if (now - last_report >= seconds{1}) {
+                report_emulation_timing();
+                last_report = now;
+            }
+            // the paced schedule picks up from here once turbo ends
+            pacer_.start(now);
+            continue;
         }
 
-        if (!chip8_paused_) {
-            cycle_forward(instructions_per_frame_ - instructions_executed);
-            instructions_executed = instructions_per_frame_;
+        const auto now = FramePacer::clock::now();
+        const auto ticks = pacer_.due(now);
+        for (auto tick = 0u; tick < ticks; ++tick) {
+            run_frame();
+        }
+        if (ticks > 0) {
+            publish_frame();
+            emulation_time_ += FramePacer::clock::now() - now;
         }
 
-        current_time = SDL_GetTicks();
-        if (current_time > last_time + 1000) {
-            spdlog::debug("Frames over last second = {}", frames_rendered);
-            frames_rendered = 0;
-            last_time = current_time;
+        if (now - last_report >= seconds{1}) {
+            report_emulation_timing();
+            last_report = now;
         }
+
+        std::this_thread::sleep_until(pacer_.next_tick());
     }
 }
 
-std::vector<u8> Emu::load_rom_file(const std::string_view &path) {
-    namespace fs = std::filesystem;
-    fs::path file_path{path};
+template <typename Core>
+void Emu<Core>::run() {
+    emulation_ = std::thread{[this] { emulate(); }};
 
-    if (!fs::is_regular_file(file_path)) {
-        spdlog::error("Rom File: {} is not a regular file", file_path.string());
-        return std::vector<u8>{};
-    }
+    auto last_report = FramePacer::clock::now();
+    while (running_) {
+        while (SDL_PollEvent(&event_) > 0) {
+            handle_event(event_);
+        }
+        keys_.store(read_keypad(), std::memory_order_relaxed);
+
+        // presenting blocks until vsync, otherwise wait for events until the
+        // next frame could be ready
+        if (frames_.update()) {
+            render();
+        } else if (SDL_WaitEventTimeout(&event_, EVENT_TIMEOUT_MS) > 0) {
+            handle_event(event_);
+        }
 
-    // stackoverflow post:
-    // https://stackoverflow.com/questions/15138353/how-to-read-a-binary-file-into-a-vector-of-unsigned-chars
-    std::ifstream rom{file_path, std::ios::binary};
-    rom.unsetf(std::ios::skipws);
-    // get size
-    rom.seekg(0, std::ios::end);
-    const auto size = rom.tellg();
-    rom.seekg(0, std::ios::beg);
+        const auto now = FramePacer::clock::now();
+        if (now - last_report >= std::chrono::seconds{1}) {
+            report_render_timing();
+            last_report = now;
+        }
+    }
 
-    spdlog::debug("Rom {} size: {}", path, size);
+    signal_control();
+    emulation_.join();
 
-    // make vector and insert
-    std::vector<u8> rom_data(size);
-    std::copy(std::istream_iterator<u8>(rom), std::istream_iterator<u8>(),
-              std::begin(rom_data));
+    if (movie_mode_ == MovieMode::record) {
+        write_movie_file(movie_path_, movie_);
+    }
+}
 
-    spdlog::debug("Printing rom_data");
-    for (auto i = 0; i < size; ++i) {
-        spdlog::debug("byte {}: {}", i, rom_data[i]);
+template <typename Core>
+bool Emu<Core>::load_rom_file(const std::string_view &path) {
+    const auto rom = MappedRom::open(path, Core::MAX_ROM_SIZE);
+    if (rom.empty()) {
+        return false;
     }
+    chip8_.load_rom(rom.bytes());
+    rom_hash_ = rom.hash();
+    return true;
+}
+
+template <typename Core>
+void Emu<Core>::record_movie(const std::filesystem::path &path) {
+    movie_path_ = path;
+    movie_ = Movie{};
+    movie_.rom_hash = rom_hash_;
+    movie_.instructions_per_frame = instructions_per_frame_;
+    movie_.variant = Core::VARIANT;
+    movie_.quirks = Core::QUIRKS;
+    movie_mode_ = MovieMode::record;
+}
 
-    // TODO: Refactor?
-    chip8_.load_rom(rom_data);
-    chip8_.set_debug_level(spdlog::level::debug);
-    return rom_data;
+template <typename Core>
+bool Emu<Core>::replay_movie(const std::filesystem::path &path) {
+    auto movie = read_movie_file(path);
+    if (!movie) {
+        return false;
+    }
+    if (movie->rom_hash != rom_hash_) {
+        spdlog::error("Movie {} was recorded with another ROM", path.string());
+        return false;
+    }
+    if (!recorded_on<Core>(*movie)) {
+        spdlog::error("Movie {} was recorded on {} with {} quirks, not {} "
+                      "with {} quirks",
+                      path.string(), movie->variant, movie->quirks,
+                      Core::VARIANT, Core::QUIRKS);
+        return false;
+    }
+    movie_ = std::move(*movie);
+    movie_frame_ = 0;
+    // the same instructions per frame as the recording keeps it exact
+    instructions_per_frame_ = movie_.instructions_per_frame;
+    movie_mode_ = MovieMode::replay;
+    return true;
 }
+
+template class Emu<Chip8>;
+template class Emu<Chip8Core<variant::Chip8, quirks::Cosmac>>;
+template class Emu<Chip8Core<variant::Chip8, quirks::SuperChip>>;
+template class Emu<Chip8Core<variant::Chip8, quirks::XoChip>>;
+template class Emu<SuperChip>;
+template class Emu<XoChip>;
@@ -1,57 +1,210 @@
 #include "SDL.h"
 #include "spdlog/spdlog.h"
 
+#include "audio.h"
 #include "chip8.h"
 #include "common.h"
+#include "frame_pacer.h"
+#include "movie.h"
+#include "rom.h"
+#include "screen_renderer.h"
+#include "triple_buffer.h"
 #include <SDL_pixels.h>
 #include <SDL_render.h>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
 #include <exception>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <fstream>
 #include <string_view>
+#include <thread>
 
-class Emu {
-
+/// The parts of Emu which do not depend on the core it runs.
+class EmuBase {
   public:
     enum class State { Debug, Pause, Run };
+    enum class MovieMode { none, record, replay };
+
+    /// time spent presenting frames
+    struct RenderStats {
+        u64 frames = 0;
+        std::chrono::nanoseconds total_time{0};
+        std::chrono::nanoseconds max_time{0};
+    };
+
+    /// time spent running frames and handing them to the renderer
+    struct EmulationStats {
+        // paced frames and how late they ran
+        FramePacer::Stats pacer;
+        // frames run as fast as possible in turbo
+        u64 turbo_frames = 0;
+        std::chrono::nanoseconds time_per_frame{0};
+        // screens published since run() started, and those overwritten
+        // before the renderer picked them up
+        u64 published = 0;
+        u64 overwritten = 0;
+    };
+};
 
+/// Runs a @tparam Core, Chip8, SuperChip or XoChip, on an emulation thread
+/// paced at frames_per_second_, which publishes each finished screen through
+/// a triple buffer. The thread calling run() only polls SDL events, forwards
+/// them to the emulation thread and presents the latest screen, so a present
+/// blocked on vsync never holds up emulation.
+template <typename Core> class Emu : public EmuBase {
   private:
     SDL_Window *window_ = nullptr;
     SDL_Renderer *renderer_ = nullptr;
     SDL_Event event_;
 
-    Chip8 chip8_;
+    Core chip8_;
+    ScreenRenderer<Core> screen_renderer_;
     u8 screen_scale_;
     State state_;
     u32 screen_width_;
     u32 screen_height_;
     u32 frames_per_second_ = 60;
     u32 instructions_per_frame_ = 10;
-    bool running_ = true;
-    bool chip8_paused_ = true;
+    // written by the thread calling run(), read by the emulation thread
+    std::atomic<bool> running_ = true;
+    std::atomic<bool> chip8_paused_ = true;
+    // single instructions requested while paused
+    std::atomic<u32> step_requests_ = 0;
+    // held keypad keys, bit k for key k
+    std::atomic<u16> keys_ = 0;
+    // run frames as fast as possible instead of at frames_per_second_
+    std::atomic<bool> turbo_ = false;
+    // bumped and notified after any of the above change
+    std::atomic<u32> control_ = 0;
+
+    // runs emulate(). While it runs chip8_ and everything down to
+    // movie_frame_ belong to it
+    std::thread emulation_;
+    // runs the chip8 frames at frames_per_second_
+    FramePacer pacer_;
+    // the frames shown in turbo
+    FrameSkip frame_skip_;
+    // time spent running frames since the last report
+    std::chrono::nanoseconds emulation_time_{0};
+    // frames run in turbo since the last report
+    u64 turbo_frames_ = 0;
+    // finished screens handed to the renderer
+    TripleBuffer<typename Core::Screen> frames_;
+    // input of every frame, recorded from or replayed instead of keys_
+    MovieMode movie_mode_ = MovieMode::none;
+    Movie movie_;
+    u32 movie_frame_ = 0;
+
+    // fed the sound timer by the emulation thread, played by audio_sink_
+    AudioOutput audio_;
+    std::unique_ptr<AudioSink> audio_sink_;
+
+    // owned by the thread calling run()
+    RenderStats render_stats_;
+    // the stats of the last report of each thread
+    mutable std::mutex stats_mutex_;
+    EmulationStats last_emulation_stats_;
+    RenderStats last_render_stats_;
     // colors
-    const u8 background_red = 0x0F;
-    const u8 background_green = 0x0F;
-    const u8 background_blue = 0xFF;
+    static constexpr u8 background_red = 0x0F;
+    static constexpr u8 background_green = 0x0F;
+    static constexpr u8 background_blue = 0xFF;
+
+    static constexpr u8 pixel_red = 0xFF;
+    static constexpr u8 pixel_green = 0x00;
+    static constexpr u8 pixel_blue = 0x0F;
+
+    // pixels set only in the second bitplane of XO-CHIP, and in both
+    static constexpr u8 plane2_red = 0x0F;
+    static constexpr u8 plane2_green = 0xFF;
+    static constexpr u8 plane2_blue = 0x0F;
 
-    const u8 pixel_red = 0xFF;
-    const u8 pixel_green = 0x00;
-    const u8 pixel_blue = 0x0F;
+    static constexpr u8 both_red = 0xFF;
+    static constexpr u8 both_green = 0xFF;
+    static constexpr u8 both_blue = 0xFF;
+
+    // hash of the loaded ROM, stored in recorded movies
+    u64 rom_hash_ = 0;
+    std::filesystem::path movie_path_;
 
     // constants
     const char *WINDOW_NAME = "Chip8-cpp";
+    // keys of the hex keypad on the left of a QWERTY keyboard:
+    //   1 2 3 C      1 2 3 4
+    //   4 5 6 D      Q W E R
+    //   7 8 9 E  ->  A S D F
+    //   A 0 B F      Z X C V
+    static constexpr std::array<SDL_Scancode, 16> KEYPAD = {
+        SDL_SCANCODE_X, SDL_SCANCODE_1, SDL_SCANCODE_2, SDL_SCANCODE_3,
+        SDL_SCANCODE_Q, SDL_SCANCODE_W, SDL_SCANCODE_E, SDL_SCANCODE_A,
+        SDL_SCANCODE_S, SDL_SCANCODE_D, SDL_SCANCODE_Z, SDL_SCANCODE_C,
+        SDL_SCANCODE_4, SDL_SCANCODE_R, SDL_SCANCODE_F, SDL_SCANCODE_V,
+    };
+    // longest the render loop waits for an event without a new frame
+    static constexpr int EVENT_TIMEOUT_MS = 2;
 
+    static typename ScreenRenderer<Core>::Palette palette() noexcept;
     u32 init_SDL();
+    void init_audio();
+    u16 read_keypad() const noexcept;
+    void emulate();
+    void run_frame();
+    void publish_frame();
+    // wakes the emulation thread after a control change
+    void signal_control() noexcept;
+    void report_emulation_timing();
+    void report_render_timing();
 
   public:
-    Emu(u8 screen_scale, State state);
+    /// plays the beep with @param audio
+    Emu(u8 screen_scale, State state, AudioConfig audio = {});
     ~Emu();
 
+    /// starts the emulation thread and handles events and rendering until
+    /// the window is closed
     void run();
-    void cycle_forward(u8 cycles_remaining);
+    void cycle_forward(u32 cycles);
+    /// presents the latest published frame
     void render();
+    /// executes a single instruction and publishes the screen, only called
+    /// by the emulation thread
     void step();
+    /// returns the number of single instructions requested
     u8 handle_event(const SDL_Event &event);
-    std::vector<u8> load_rom_file(const std::string_view &path);
+    /// maps the ROM at @param path into the core, returns false if it can
+    /// not be loaded
+    bool load_rom_file(const std::string_view &path);
+    /// instructions run per emulated frame, 10 by default. Call before run()
+    void set_instructions_per_frame(u32 instructions) noexcept {
+        instructions_per_frame_ = instructions;
+    }
+    /// turbo runs frames as fast as the host allows, timers still tick once
+    /// per emulated frame. Tab toggles it while running
+    void set_turbo(bool turbo) noexcept { turbo_ = turbo; }
+    /// in turbo shows every @param every_nth frame, with 0 one frame per
+    /// display refresh of wall-clock time. Call before run()
+    void set_frame_skip(u32 every_nth) noexcept {
+        frame_skip_ = FrameSkip{every_nth};
+    }
+    /// the emulation timing over the last second, callable from any thread
+    EmulationStats emulation_stats() const;
+    /// the render timing over the last second, callable from any thread
+    RenderStats render_stats() const;
+    /// records the keypad of every frame, written to @param path once run()
+    /// returns. Call after load_rom_file
+    void record_movie(const std::filesystem::path &path);
+    /// replays the keypad from the movie at @param path, falling back to
+    /// the keyboard once it ends. Returns false if it can not be read or
+    /// was recorded with another ROM. Call after load_rom_file
+    bool replay_movie(const std::filesystem::path &path);
 };
+
+extern template class Emu<Chip8>;
+extern template class Emu<Chip8Core<variant::Chip8, quirks::Cosmac>>;
+extern template class Emu<Chip8Core<variant::Chip8, quirks::SuperChip>>;
+extern template class Emu<Chip8Core<variant::Chip8, quirks::XoChip>>;
+extern template class Emu<SuperChip>;
+extern template class Emu<XoChip>;
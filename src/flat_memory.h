@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <span>
+
+#include "common.h"
+
+/// Chip8 memory of @tparam Size bytes held in one inline array, the default
+/// memory model. Reads and writes index the array directly, and an image
+/// passed to share() is copied in. BasicPagedMemory shares pages between
+/// instances instead.
+template <u32 Size> class FlatMemory {
+  public:
+    static constexpr u32 SIZE = Size;
+
+    /// complete contents of memory
+    using Image = std::array<u8, SIZE>;
+
+    u8 operator[](u32 address) const noexcept {
+        return bytes_[address % SIZE];
+    }
+
+    void write(u32 address, u8 value) noexcept {
+        bytes_[address % SIZE] = value;
+    }
+
+    /// replaces the contents with a copy of @param image
+    void share(std::shared_ptr<const Image> image) noexcept {
+        bytes_ = *image;
+    }
+    /// replaces the contents with @param bytes
+    void assign(std::span<const u8, SIZE> bytes) noexcept {
+        std::ranges::copy(bytes, bytes_.begin());
+    }
+    /// copies the contents to @param bytes
+    void copy_to(std::span<u8, SIZE> bytes) const noexcept {
+        std::ranges::copy(bytes_, bytes.begin());
+    }
+
+  private:
+    Image bytes_ = {0x0};
+};
@@ -0,0 +1,32 @@
+#include "frame_pacer.h"
+
+#include <algorithm>
+
+u32 FramePacer::due(clock::time_point now) noexcept {
+    if (now < next_tick_) {
+        return 0;
+    }
+
+    const auto lateness = now - next_tick_;
+    auto ticks = static_cast<u32>(lateness / period_) + 1;
+    if (ticks > max_catch_up_) {
+        // too far behind to catch up, run one tick and resync to now
+        stats_.dropped_ticks += ticks - 1;
+        ticks = 1;
+        next_tick_ = now + period_;
+    } else {
+        next_tick_ += period_ * ticks;
+    }
+
+    stats_.ticks += ticks;
+    ++stats_.wakeups;
+    stats_.total_lateness += lateness;
+    stats_.max_lateness = std::max(stats_.max_lateness, lateness);
+    return ticks;
+}
+
+FramePacer::Stats FramePacer::take_stats() noexcept {
+    const auto stats = stats_;
+    stats_ = Stats{};
+    return stats;
+}
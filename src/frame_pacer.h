@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+
+#include "common.h"
+
+/// Schedules fixed rate ticks (the 60 Hz Chip8 frame) against a steady clock.
+/// The caller asks how many ticks are due, runs them, and waits until
+/// next_tick(). Ticks missed during a short stall are caught up, a stall
+/// longer than max_catch_up ticks drops the backlog and restarts the
+/// schedule from now.
+class FramePacer {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct Stats {
+        u64 ticks = 0;
+        u64 dropped_ticks = 0;
+        // calls to due() which returned ticks
+        u64 wakeups = 0;
+        // how late the first due tick was when due() was called
+        clock::duration total_lateness{0};
+        clock::duration max_lateness{0};
+
+        clock::duration average_lateness() const noexcept {
+            if (wakeups == 0) {
+                return clock::duration{0};
+            }
+            return total_lateness / static_cast<clock::rep>(wakeups);
+        }
+    };
+
+    explicit FramePacer(u32 ticks_per_second = 60, u32 max_catch_up = 5)
+        : period_{std::chrono::duration_cast<clock::duration>(
+              std::chrono::seconds{1}) /
+                  static_cast<clock::rep>(ticks_per_second)},
+          max_catch_up_{max_catch_up} {}
+
+    /// (re)starts the schedule with the first tick due at @param now
+    void start(clock::time_point now) noexcept { next_tick_ = now; }
+
+    /// returns how many ticks are due at @param now and moves the schedule
+    /// past them
+    u32 due(clock::time_point now) noexcept;
+
+    clock::time_point next_tick() const noexcept { return next_tick_; }
+    clock::duration period() const noexcept { return period_; }
+
+    /// returns the stats gathered since the last call and resets them
+    Stats take_stats() noexcept;
+
+  private:
+    clock::duration period_;
+    u32 max_catch_up_;
+    clock::time_point next_tick_{};
+    Stats stats_;
+};
+
+/// Picks which frames to show while frames run faster than they can be
+/// displayed. Shows every nth frame, or with n == 0 the first frame after
+/// each display period of wall-clock time.
+class FrameSkip {
+  public:
+    using clock = FramePacer::clock;
+
+    explicit FrameSkip(u32 every_nth = 0, u32 displays_per_second = 60)
+        : every_nth_{every_nth},
+          display_period_{std::chrono::duration_cast<clock::duration>(
+                              std::chrono::seconds{1}) /
+                          static_cast<clock::rep>(displays_per_second)} {}
+
+    /// call once per emulated frame, returns true if the frame finished at
+    /// @param now should be shown
+    bool show(clock::time_point now) noexcept {
+        if (every_nth_ > 0) {
+            frames_ = (frames_ + 1) % every_nth_;
+            return frames_ == 0;
+        }
+        if (now < next_display_) {
+            return false;
+        }
+        next_display_ = now + display_period_;
+        return true;
+    }
+
+  private:
+    u32 every_nth_;
+    clock::duration display_period_;
+    u32 frames_ = 0;
+    clock::time_point next_display_{};
+};
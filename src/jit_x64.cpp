@@ -0,0 +1,512 @@
+#include "jit_x64.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "spdlog/spdlog.h"
+
+#include "chip8.h"
+
+#if defined(__x86_64__) && defined(__unix__)
+#define CHIP8_JIT_X64 1
+#include <sys/mman.h>
+#else
+#define CHIP8_JIT_X64 0
+#endif
+
+namespace {
+
+// x86-64 register numbers
+enum Reg : u8 {
+    rax = 0,
+    rcx = 1,
+    rdx = 2,
+    rbx = 3,
+    rsp = 4,
+    rbp = 5,
+    rsi = 6,
+    rdi = 7,
+    r8 = 8,
+    r9 = 9,
+    r10 = 10,
+    r11 = 11,
+    r12 = 12,
+    r13 = 13,
+    r14 = 14,
+    r15 = 15,
+};
+
+// Register use inside a block:
+//   rbx  Chip8::State *
+//   r12  Jit *, passed to call_execute
+//   ebp  instruction budget
+//   rax, rcx, rdx, rsi, rdi  scratch
+// The V registers a block uses most are cached in the pool below and
+// written back before calls into the interpreter and on exit.
+constexpr std::array<Reg, 7> V_REGISTER_POOL = {r13, r14, r15, r8,
+                                                r9,  r10, r11};
+
+constexpr std::int32_t offset_of_V(u32 reg) {
+    return static_cast<std::int32_t>(offsetof(Chip8::Machine, V) + reg);
+}
+constexpr std::int32_t OFFSET_PC = offsetof(Chip8::Machine, pc);
+constexpr std::int32_t OFFSET_I = offsetof(Chip8::Machine, I);
+constexpr std::int32_t OFFSET_BAD_OPCODE = offsetof(Chip8::Machine, bad_opcode);
+
+/// a V register, either cached in a host register or in State::V
+struct Location {
+    bool in_register;
+    u8 reg;
+    std::int32_t disp;
+};
+
+class Emitter {
+  public:
+    std::vector<u8> code;
+
+    void byte(u8 b) { code.push_back(b); }
+    void bytes(std::initializer_list<u8> bs) {
+        code.insert(code.end(), bs.begin(), bs.end());
+    }
+    void imm16(u16 value) {
+        byte(value & 0xFF);
+        byte(value >> 8);
+    }
+    void imm32(u32 value) {
+        for (auto i = 0u; i < 4; ++i) {
+            byte((value >> (8 * i)) & 0xFF);
+        }
+    }
+    void imm64(u64 value) {
+        for (auto i = 0u; i < 8; ++i) {
+            byte((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    // the REX prefix is always emitted for byte operands so that registers
+    // 4 to 7 mean spl to dil and 8 to 15 are reachable
+    void rex(u8 reg, u8 rm) {
+        byte(0x40 | (((reg >> 3) & 1) << 2) | ((rm >> 3) & 1));
+    }
+    void modrm(u8 mod, u8 reg, u8 rm) {
+        byte((mod << 6) | ((reg & 7) << 3) | (rm & 7));
+    }
+    // [rbx + disp32]
+    void state_operand(u8 reg, std::int32_t disp) {
+        modrm(0b10, reg, rbx);
+        imm32(static_cast<u32>(disp));
+    }
+
+    /// op r/m8, r8
+    void op_rm_r(u8 opcode, Location dst, u8 src) {
+        if (dst.in_register) {
+            rex(src, dst.reg);
+            byte(opcode);
+            modrm(0b11, src, dst.reg);
+        } else {
+            rex(src, rbx);
+            byte(opcode);
+            state_operand(src, dst.disp);
+        }
+    }
+
+    /// op r8, r/m8
+    void op_r_rm(u8 opcode, u8 dst, Location src) {
+        if (src.in_register) {
+            rex(dst, src.reg);
+            byte(opcode);
+            modrm(0b11, dst, src.reg);
+        } else {
+            rex(dst, rbx);
+            byte(opcode);
+            state_operand(dst, src.disp);
+        }
+    }
+
+    /// dst = dst op src for the byte ops with both r/m8, r8 and r8, r/m8
+    /// encodings (mov, or, and, xor)
+    void binary(u8 rm_r, u8 r_rm, Location dst, Location src) {
+        if (src.in_register) {
+            op_rm_r(rm_r, dst, src.reg);
+        } else if (dst.in_register) {
+            op_r_rm(r_rm, dst.reg, src);
+        } else {
+            // no memory to memory forms, go through al
+            op_r_rm(0x8A, rax, src);
+            op_rm_r(rm_r, dst, rax);
+        }
+    }
+
+    void mov_imm8(Location dst, u8 value) {
+        if (dst.in_register) {
+            rex(0, dst.reg);
+            byte(0xB0 + (dst.reg & 7));
+        } else {
+            byte(0xC6);
+            state_operand(0, dst.disp);
+        }
+        byte(value);
+    }
+
+    void add_imm8(Location dst, u8 value) {
+        if (dst.in_register) {
+            rex(0, dst.reg);
+            byte(0x80);
+            modrm(0b11, 0, dst.reg);
+        } else {
+            byte(0x80);
+            state_operand(0, dst.disp);
+        }
+        byte(value);
+    }
+
+    /// mov word [rbx + disp], value
+    void store_imm16(std::int32_t disp, u16 value) {
+        bytes({0x66, 0xC7});
+        state_operand(0, disp);
+        imm16(value);
+    }
+
+    /// mov byte [rbx + disp], value
+    void store_imm8(std::int32_t disp, u8 value) {
+        byte(0xC6);
+        state_operand(0, disp);
+        byte(value);
+    }
+
+    /// emits a rel32 jump with opcode @param prefix and returns the position
+    /// of the displacement to patch
+    std::size_t jump(std::initializer_list<u8> prefix) {
+        bytes(prefix);
+        const auto position = code.size();
+        imm32(0);
+        return position;
+    }
+
+    void patch(std::size_t position, std::size_t target) {
+        const auto rel = static_cast<std::int32_t>(target - (position + 4));
+        std::memcpy(code.data() + position, &rel, sizeof(rel));
+    }
+};
+
+bool native(Op op) {
+    switch (op) {
+    case Op::_6XNN:
+    case Op::_7XNN:
+    case Op::_8XY0:
+    case Op::_8XY1:
+    case Op::_8XY2:
+    case Op::_8XY3:
+    case Op::_ANNN:
+        return true;
+    default:
+        return false;
+    }
+}
+
+#if CHIP8_JIT_X64
+u8 *map_buffer(std::size_t size) {
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return memory == MAP_FAILED ? nullptr : static_cast<u8 *>(memory);
+}
+#endif
+
+} // namespace
+
+Jit::Jit() : block_at_(ADDRESS_SPACE, 0) {
+#if CHIP8_JIT_X64
+    buffer_ = map_buffer(BUFFER_SIZE);
+#endif
+}
+
+Jit::~Jit() {
+#if CHIP8_JIT_X64
+    if (buffer_) {
+        munmap(buffer_, BUFFER_SIZE);
+    }
+#endif
+}
+
+bool Jit::supported() noexcept {
+#if CHIP8_JIT_X64
+    static const bool mappable = [] {
+        u8 *probe = map_buffer(4096);
+        if (!probe) {
+            return false;
+        }
+        const auto executable = mprotect(probe, 4096, PROT_READ | PROT_EXEC);
+        munmap(probe, 4096);
+        return executable == 0;
+    }();
+    return mappable;
+#else
+    return false;
+#endif
+}
+
+void Jit::flush() noexcept {
+    blocks_.clear();
+    std::ranges::fill(block_at_, 0);
+    code_.reset();
+    used_ = 0;
+    ++generation_;
+}
+
+u32 Jit::call_execute(Jit *jit, u32 opcode) noexcept {
+    const auto generation = jit->generation_;
+    jit->current_->execute(static_cast<u16>(opcode));
+    return jit->generation_ != generation ? 1 : 0;
+}
+
+Jit::BlockFn Jit::install(std::span<const u8> code) {
+#if CHIP8_JIT_X64
+    if (!buffer_ || code.size() > BUFFER_SIZE) {
+        return nullptr;
+    }
+    if (used_ + code.size() > BUFFER_SIZE) {
+        flush();
+    }
+
+    mprotect(buffer_, BUFFER_SIZE, PROT_READ | PROT_WRITE);
+    u8 *entry = buffer_ + used_;
+    std::memcpy(entry, code.data(), code.size());
+    // keep entries 16 byte aligned
+    used_ = (used_ + code.size() + 15) & ~std::size_t{15};
+    mprotect(buffer_, BUFFER_SIZE, PROT_READ | PROT_EXEC);
+
+    return reinterpret_cast<BlockFn>(entry);
+#else
+    static_cast<void>(code);
+    return nullptr;
+#endif
+}
+
+// opcodes[k] is at start + 2k, none of them may end a block
+Jit::CompiledBlock Jit::compile(std::span<const u16> opcodes, u16 start) {
+    const auto length = static_cast<u32>(opcodes.size());
+    auto address = [start](u32 k) { return static_cast<u16>(start + 2 * k); };
+
+    // cache the V registers the native instructions use most
+    std::array<u32, 16> uses = {0};
+    for (const auto opcode : opcodes) {
+        const auto op = decode(opcode);
+        if (!native(op) || op == Op::_ANNN) {
+            continue;
+        }
+        ++uses[nibble(nib::second, opcode)];
+        if (op != Op::_6XNN && op != Op::_7XNN) {
+            ++uses[nibble(nib::third, opcode)];
+        }
+    }
+    std::array<u8, 16> order = {0};
+    for (auto reg = 0u; reg < 16; ++reg) {
+        order[reg] = static_cast<u8>(reg);
+    }
+    std::ranges::stable_sort(order, [&uses](u8 a, u8 b) {
+        return uses[a] > uses[b];
+    });
+
+    std::array<Location, 16> V = {};
+    for (auto reg = 0u; reg < 16; ++reg) {
+        V[reg] = {false, 0, offset_of_V(reg)};
+    }
+    std::vector<u8> cached;
+    for (auto i = 0u; i < V_REGISTER_POOL.size(); ++i) {
+        if (uses[order[i]] == 0) {
+            break;
+        }
+        V[order[i]].in_register = true;
+        V[order[i]].reg = V_REGISTER_POOL[i];
+        cached.push_back(order[i]);
+    }
+
+    Emitter e;
+    auto load_cached = [&] {
+        for (const auto reg : cached) {
+            e.op_r_rm(0x8A, V[reg].reg, {false, 0, V[reg].disp});
+        }
+    };
+    auto spill_cached = [&] {
+        for (const auto reg : cached) {
+            e.op_rm_r(0x88, {false, 0, V[reg].disp}, V[reg].reg);
+        }
+    };
+
+    // prologue, leaves rsp 16 byte aligned for calls
+    e.bytes({0x53, 0x55, 0x41, 0x54, 0x41, 0x55, 0x41, 0x56, 0x41, 0x57});
+    e.bytes({0x48, 0x83, 0xEC, 0x08}); // sub rsp, 8
+    e.bytes({0x48, 0x89, 0xFB});       // mov rbx, rdi
+    e.bytes({0x49, 0x89, 0xF4});       // mov r12, rsi
+    e.bytes({0x89, 0xD5});             // mov ebp, edx
+    load_cached();
+
+    // jumps to the exit stub for "k instructions executed"
+    std::vector<std::pair<std::size_t, u32>> exits;
+
+    for (auto k = 0u; k < length; ++k) {
+        const auto opcode = opcodes[k];
+        const auto op = decode(opcode);
+        const auto x = nibble(nib::second, opcode);
+        const auto y = nibble(nib::third, opcode);
+        const auto nn = static_cast<u8>(opcode & 0x00FF);
+
+        if (k > 0) {
+            // leave once the budget is used up
+            e.bytes({0x83, 0xFD, static_cast<u8>(k)}); // cmp ebp, k
+            exits.emplace_back(e.jump({0x0F, 0x86}), k); // jbe
+        }
+
+        switch (op) {
+        case Op::_6XNN:
+            e.mov_imm8(V[x], nn);
+            break;
+        case Op::_7XNN:
+            e.add_imm8(V[x], nn);
+            break;
+        case Op::_8XY0:
+            e.binary(0x88, 0x8A, V[x], V[y]);
+            break;
+        case Op::_8XY1:
+            e.binary(0x08, 0x0A, V[x], V[y]);
+            break;
+        case Op::_8XY2:
+            e.binary(0x20, 0x22, V[x], V[y]);
+            break;
+        case Op::_8XY3:
+            e.binary(0x30, 0x32, V[x], V[y]);
+            break;
+        case Op::_ANNN:
+            e.store_imm16(OFFSET_I, opcode & 0x0FFF);
+            break;
+        default:
+            // call back into the interpreter with the registers in memory
+            spill_cached();
+            e.store_imm16(OFFSET_PC, address(k + 1));
+            e.bytes({0x4C, 0x89, 0xE7}); // mov rdi, r12
+            e.byte(0xBE);                // mov esi, opcode
+            e.imm32(opcode);
+            e.bytes({0x48, 0xB8}); // mov rax, call_execute
+            e.imm64(reinterpret_cast<u64>(&Jit::call_execute));
+            e.bytes({0xFF, 0xD0}); // call rax
+            load_cached();
+            // a store flushed the translated code, leave right away
+            e.bytes({0x85, 0xC0}); // test eax, eax
+            exits.emplace_back(e.jump({0x0F, 0x85}), k + 1); // jnz
+            break;
+        }
+    }
+    exits.emplace_back(e.jump({0xE9}), length); // jmp
+
+    // exit with eax = instructions executed and cx = pc
+    const auto common_exit = e.code.size();
+    e.bytes({0x66, 0x89});
+    e.state_operand(rcx, OFFSET_PC);
+    spill_cached();
+    e.bytes({0x48, 0x83, 0xC4, 0x08}); // add rsp, 8
+    e.bytes({0x41, 0x5F, 0x41, 0x5E, 0x41, 0x5D, 0x41, 0x5C, 0x5D, 0x5B});
+    e.byte(0xC3); // ret
+
+    std::vector<std::size_t> stubs(length + 1, 0);
+    for (auto k = 1u; k <= length; ++k) {
+        stubs[k] = e.code.size();
+        e.byte(0xB8); // mov eax, k
+        e.imm32(k);
+        e.byte(0xB9); // mov ecx, pc
+        e.imm32(address(k));
+        // execute() clears bad_opcode for every instruction, the natively
+        // emitted ones have to do it themselves
+        if (native(decode(opcodes[k - 1]))) {
+            e.store_imm8(OFFSET_BAD_OPCODE, 0);
+        }
+        e.patch(e.jump({0xE9}), common_exit);
+    }
+    for (const auto &[position, k] : exits) {
+        e.patch(position, stubs[k]);
+    }
+
+    return {install(e.code), length};
+}
+
+const Jit::CompiledBlock &Jit::translate(Chip8 &chip8, u16 start) {
+    const auto &memory = chip8.memory_;
+    std::vector<u16> opcodes;
+    auto address = start;
+    while (address < ADDRESS_SPACE - 1 && opcodes.size() < MAX_BLOCK_LENGTH) {
+        const u16 opcode = (memory[address] << 8) + memory[address + 1];
+        if (ends_block(decode(opcode))) {
+            break;
+        }
+        opcodes.push_back(opcode);
+        address += 2;
+    }
+
+    auto block = CompiledBlock{};
+    if (!opcodes.empty()) {
+        block = compile(opcodes, start);
+        if (!block.entry) {
+            // out of executable memory, interpret instead
+            block.length = 0;
+        }
+    }
+    // compile may have flushed, so register the block afterwards
+    for (auto covered = start; covered < address; ++covered) {
+        code_.set(covered);
+    }
+    blocks_.push_back(block);
+    block_at_[start] = static_cast<u16>(blocks_.size());
+    CHIP8_TRACE(decode, "Translated block {:x}-{:x} with {} instructions",
+                start, address, block.length);
+    return blocks_.back();
+}
+
+u32 Jit::run(Chip8 &chip8, u32 cycles) noexcept {
+    current_ = &chip8;
+    auto executed = 0u;
+
+    while (executed < cycles) {
+        const auto start = chip8.state_.pc;
+        if (start >= ADDRESS_SPACE - 1) {
+            break;
+        }
+        // blocks start at jump targets, where idle loops are entered
+        if (const auto skipped = chip8.skip_idle(cycles - executed);
+            skipped > 0) {
+            executed += skipped;
+            continue;
+        }
+        const auto index = block_at_[start];
+        const auto block =
+            index != 0 ? blocks_[index - 1] : translate(chip8, start);
+
+        if (block.length == 0) {
+            // the block starts with a jump, call, return or skip
+            chip8.cycle();
+            ++executed;
+            continue;
+        }
+        executed += block.entry(&chip8.state_, this, cycles - executed);
+    }
+    return executed;
+}
+
+void Jit::execute(Chip8 &chip8, u16 opcode) noexcept {
+    if (ends_block(decode(opcode))) {
+        chip8.execute(opcode);
+        return;
+    }
+
+    // compile as if fetched from pc - 2 so the block exits with the pc
+    // where it was
+    const auto block =
+        compile(std::span{&opcode, 1}, static_cast<u16>(chip8.state_.pc - 2));
+    if (!block.entry) {
+        chip8.execute(opcode);
+        return;
+    }
+    current_ = &chip8;
+    block.entry(&chip8.state_, this, 1);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <bitset>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "common.h"
+#include "decode.h"
+#include "variant.h"
+
+/// Dynamic recompiler translating Chip8 basic blocks into x86-64 code.
+///
+/// A block runs from its start address up to, but not including, the next
+/// instruction which can move the pc (jumps, calls, returns, skips), those
+/// are left to the interpreter. Register and I loads, 7XNN and the 8XY0 to
+/// 8XY3 logic ops are emitted natively with the V registers they touch held
+/// in host registers. Everything else, DXYN included, is a call back into
+/// Chip8::execute. A store into translated code flushes every block, and the
+/// block doing the store returns right after it.
+class Jit {
+  public:
+    Jit();
+    ~Jit();
+
+    Jit(const Jit &) = delete;
+    Jit &operator=(const Jit &) = delete;
+
+    /// false when the host is not x86-64 or executable memory is not
+    /// available, Chip8 then falls back to the interpreter
+    static bool supported() noexcept;
+
+    /// executes up to @param cycles instructions of @param chip8, returns
+    /// how many ran. Stops early if the pc runs off the end of memory
+    u32 run(Chip8 &chip8, u32 cycles) noexcept;
+
+    /// translates and runs the single instruction @param opcode the same way
+    /// Chip8::execute does, leaving the pc alone
+    void execute(Chip8 &chip8, u16 opcode) noexcept;
+
+    /// true if @param address is part of a translated block
+    bool covers(u16 address) const noexcept { return code_.test(address); }
+    /// drops every translated block
+    void flush() noexcept;
+
+  private:
+    static constexpr u32 ADDRESS_SPACE = 4096;
+    static constexpr u32 MAX_BLOCK_LENGTH = 64;
+    static constexpr std::size_t BUFFER_SIZE = 1 << 20;
+
+    // state, jit, budget, returns the number of instructions executed
+    using BlockFn = u32 (*)(void *, Jit *, u32);
+
+    struct CompiledBlock {
+        BlockFn entry = nullptr;
+        // instructions in the block, 0 if it starts with a terminator
+        u32 length = 0;
+    };
+
+    u8 *buffer_ = nullptr;
+    std::size_t used_ = 0;
+    std::vector<CompiledBlock> blocks_;
+    // 1 + index into blocks_ of the block starting at an address
+    std::vector<u16> block_at_;
+    // addresses covered by a translated block
+    std::bitset<ADDRESS_SPACE> code_;
+    // bumped on every flush so a running block can notice
+    u32 generation_ = 0;
+    // the machine the running block belongs to
+    Chip8 *current_ = nullptr;
+
+    const CompiledBlock &translate(Chip8 &chip8, u16 start);
+    CompiledBlock compile(std::span<const u16> opcodes, u16 start);
+    BlockFn install(std::span<const u8> code);
+
+    // executes @param opcode on current_, returns 1 if that flushed the
+    // translated code
+    static u32 call_execute(Jit *jit, u32 opcode) noexcept;
+};
@@ -0,0 +1,390 @@
+#include "lockstep.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "decode.h"
+
+namespace {
+
+// GCC vector extensions, 32 bytes wide. They lower to AVX2 in the avx2
+// clones below and to pairs of SSE2 operations otherwise
+using u8x16 = u8 __attribute__((vector_size(16)));
+using u8x32 = u8 __attribute__((vector_size(32)));
+using u16x16 = u16 __attribute__((vector_size(32)));
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CHIP8_SIMD_CLONES __attribute__((target_clones("avx2", "default")))
+#else
+#define CHIP8_SIMD_CLONES
+#endif
+
+// by reference, vectors wider than the baseline ISA have no stable by value
+// ABI
+template <typename Vector, typename T>
+void load(Vector &vector, const T *source) {
+    std::memcpy(&vector, source, sizeof(vector));
+}
+
+template <typename Vector, typename T>
+void store(T *destination, const Vector &vector) {
+    std::memcpy(destination, &vector, sizeof(vector));
+}
+
+// every kernel works on whole blocks of 32 lanes and only changes the lanes
+// under mask
+
+// sets the masks to the lanes at @param pc, returns how many there are
+CHIP8_SIMD_CLONES u32 match_pc(const u16 *pcs, u16 pc, u8 *mask8,
+                               u16 *mask16, u32 lanes) {
+    // per position count of matching lanes, summed up at the end
+    u16x16 counts = {};
+    for (auto i = 0u; i < lanes; i += 16) {
+        u16x16 lane_pcs;
+        load(lane_pcs, pcs + i);
+        const auto matches = reinterpret_cast<u16x16>(lane_pcs == pc);
+        store(mask16 + i, matches);
+        store(mask8 + i, __builtin_convertvector(matches, u8x16));
+        counts += matches & 0x1u;
+    }
+    auto count = 0u;
+    for (auto lane = 0u; lane < 16; ++lane) {
+        count += counts[lane];
+    }
+    return count;
+}
+
+CHIP8_SIMD_CLONES void set_u8(u8 *destination, u8 value, const u8 *mask,
+                              u32 lanes) {
+    for (auto i = 0u; i < lanes; i += 32) {
+        u8x32 m;
+        load(m, mask + i);
+        u8x32 old;
+        load(old, destination + i);
+        store(destination + i, (m & value) | (~m & old));
+    }
+}
+
+CHIP8_SIMD_CLONES void add_u8(u8 *destination, u8 value, const u8 *mask,
+                              u32 lanes) {
+    for (auto i = 0u; i < lanes; i += 32) {
+        u8x32 m;
+        load(m, mask + i);
+        u8x32 old;
+        load(old, destination + i);
+        store(destination + i, old + (m & value));
+    }
+}
+
+enum class Logic { copy, bit_or, bit_and, bit_xor };
+
+CHIP8_SIMD_CLONES void logic_u8(Logic logic, u8 *destination,
+                                const u8 *source, const u8 *mask, u32 lanes) {
+    for (auto i = 0u; i < lanes; i += 32) {
+        u8x32 m;
+        load(m, mask + i);
+        u8x32 x;
+        load(x, destination + i);
+        u8x32 y;
+        load(y, source + i);
+        auto result = y;
+        switch (logic) {
+        case Logic::copy:
+            break;
+        case Logic::bit_or:
+            result = x | y;
+            break;
+        case Logic::bit_and:
+            result = x & y;
+            break;
+        case Logic::bit_xor:
+            result = x ^ y;
+            break;
+        }
+        store(destination + i, (m & result) | (~m & x));
+    }
+}
+
+CHIP8_SIMD_CLONES void set_u16(u16 *destination, u16 value, const u16 *mask,
+                               u32 lanes) {
+    for (auto i = 0u; i < lanes; i += 16) {
+        u16x16 m;
+        load(m, mask + i);
+        u16x16 old;
+        load(old, destination + i);
+        store(destination + i, (m & value) | (~m & old));
+    }
+}
+
+CHIP8_SIMD_CLONES void add_u16(u16 *destination, u16 value, const u16 *mask,
+                               u32 lanes) {
+    for (auto i = 0u; i < lanes; i += 16) {
+        u16x16 m;
+        load(m, mask + i);
+        u16x16 old;
+        load(old, destination + i);
+        store(destination + i, old + (m & value));
+    }
+}
+
+// decrements every non zero timer
+CHIP8_SIMD_CLONES void tick(u8 *timers, u32 lanes) {
+    for (auto i = 0u; i < lanes; i += 32) {
+        u8x32 timer;
+        load(timer, timers + i);
+        // comparisons give -1 where true
+        store(timers + i, timer + reinterpret_cast<u8x32>(timer != 0));
+    }
+}
+
+// register instructions the vector path executes
+bool vectorized(Op op) {
+    switch (op) {
+    case Op::_1NNN:
+    case Op::_6XNN:
+    case Op::_7XNN:
+    case Op::_8XY0:
+    case Op::_8XY1:
+    case Op::_8XY2:
+    case Op::_8XY3:
+    case Op::_ANNN:
+    case Op::_FX07:
+    case Op::_FX15:
+    case Op::_FX18:
+        return true;
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+Lockstep::Lockstep(const Chip8::State &initial, u32 lanes)
+    : lane_count_{lanes}, padded_count_{(lanes + BLOCK - 1) / BLOCK * BLOCK},
+      machines_(lanes) {
+    // every lane reads the initial memory from one image, copying only the
+    // pages it stores to
+    const auto image =
+        std::make_shared<const SharedChip8::Memory::Image>(initial.memory);
+    for (auto &machine : machines_) {
+        machine.share_memory(image);
+        machine.load_state(initial);
+    }
+    for (auto &V : V_) {
+        V.resize(padded_count_);
+    }
+    I_.resize(padded_count_);
+    pc_.resize(padded_count_, 0xFFFF);
+    delay_.resize(padded_count_);
+    sound_.resize(padded_count_);
+    bad_opcode_.resize(padded_count_);
+    mask8_.resize(padded_count_);
+    mask16_.resize(padded_count_);
+
+    for (auto lane = 0u; lane < lane_count_; ++lane) {
+        set_state(lane, initial);
+    }
+}
+
+void Lockstep::set_state(u32 lane, const Chip8::State &state) noexcept {
+    // opcodes are no longer shared where the new memory differs
+    const auto &memory = machines_[lane].memory();
+    for (auto address = 0u; address < Chip8::MEMORY_SIZE; ++address) {
+        if (memory[address] != state.memory[address]) {
+            written_.set(address);
+        }
+    }
+    machines_[lane].load_state(state);
+    for (auto reg = 0u; reg < 16; ++reg) {
+        V_[reg][lane] = state.V[reg];
+    }
+    I_[lane] = state.I;
+    pc_[lane] = state.pc;
+    delay_[lane] = state.delay;
+    sound_[lane] = state.sound;
+    bad_opcode_[lane] = state.bad_opcode;
+}
+
+Chip8::State Lockstep::state(u32 lane) const noexcept {
+    auto state = machines_[lane].save_state();
+    for (auto reg = 0u; reg < 16; ++reg) {
+        state.V[reg] = V_[reg][lane];
+    }
+    state.I = I_[lane];
+    state.pc = pc_[lane];
+    state.delay = delay_[lane];
+    state.sound = sound_[lane];
+    state.bad_opcode = bad_opcode_[lane];
+    return state;
+}
+
+u32 Lockstep::run(u32 cycles) noexcept {
+    for (auto steps = 0u; steps < cycles; ++steps) {
+        if (!step()) {
+            return steps;
+        }
+    }
+    return cycles;
+}
+
+void Lockstep::tick_timers() noexcept {
+    tick(delay_.data(), padded_count_);
+    tick(sound_.data(), padded_count_);
+}
+
+bool Lockstep::step() noexcept {
+    const auto halted = [this](u32 lane) {
+        return pc_[lane] >= Chip8::MEMORY_SIZE - 1;
+    };
+    if (halted(leader_)) {
+        leader_ = 0;
+        while (leader_ < lane_count_ && halted(leader_)) {
+            ++leader_;
+        }
+        if (leader_ == lane_count_) {
+            leader_ = 0;
+            return false;
+        }
+    }
+
+    const auto pc = pc_[leader_];
+    auto members =
+        match_pc(pc_.data(), pc, mask8_.data(), mask16_.data(), padded_count_);
+
+    const auto &memory = machines_[leader_].memory();
+    const u16 opcode = (memory[pc] << 8) + memory[pc + 1];
+    if (written_.test(pc) || written_.test(pc + 1)) {
+        // some lane stored here, only lanes holding the same opcode stay in
+        // the group
+        for (auto lane = 0u; lane < lane_count_; ++lane) {
+            const auto &lane_memory = machines_[lane].memory();
+            if (mask8_[lane] != 0 &&
+                ((lane_memory[pc] << 8) + lane_memory[pc + 1]) != opcode) {
+                mask8_[lane] = 0x0;
+                mask16_[lane] = 0x0;
+                --members;
+            }
+        }
+    }
+
+    if (vectorized(decode(opcode))) {
+        execute_group(opcode);
+        stats_.vector_instructions += members;
+    } else {
+        for (auto lane = 0u; lane < lane_count_; ++lane) {
+            if (mask8_[lane] != 0) {
+                scalar_cycle(lane);
+            }
+        }
+        stats_.scalar_instructions += members;
+    }
+
+    if (members == lane_count_) {
+        // no lane diverged
+        return true;
+    }
+    auto running = members;
+    auto outside = lane_count_;
+    for (auto lane = 0u; lane < lane_count_; ++lane) {
+        if (mask8_[lane] == 0 && !halted(lane)) {
+            scalar_cycle(lane);
+            ++stats_.scalar_instructions;
+            ++running;
+            outside = std::min(outside, lane);
+        }
+    }
+    // follow the bigger half if the group lost its majority
+    if (2 * members < running) {
+        leader_ = outside;
+    }
+    return true;
+}
+
+void Lockstep::execute_group(u16 opcode) noexcept {
+    const auto x = nibble(nib::second, opcode);
+    const auto y = nibble(nib::third, opcode);
+    const auto nn = static_cast<u8>(opcode & 0x00FF);
+    const auto nnn = static_cast<u16>(opcode & 0x0FFF);
+    const auto *mask8 = mask8_.data();
+    const auto *mask16 = mask16_.data();
+    const auto lanes = padded_count_;
+
+    switch (decode(opcode)) {
+    case Op::_6XNN:
+        set_u8(V_[x].data(), nn, mask8, lanes);
+        break;
+    case Op::_7XNN:
+        add_u8(V_[x].data(), nn, mask8, lanes);
+        break;
+    case Op::_8XY0:
+        logic_u8(Logic::copy, V_[x].data(), V_[y].data(), mask8, lanes);
+        break;
+    case Op::_8XY1:
+        logic_u8(Logic::bit_or, V_[x].data(), V_[y].data(), mask8, lanes);
+        break;
+    case Op::_8XY2:
+        logic_u8(Logic::bit_and, V_[x].data(), V_[y].data(), mask8, lanes);
+        break;
+    case Op::_8XY3:
+        logic_u8(Logic::bit_xor, V_[x].data(), V_[y].data(), mask8, lanes);
+        break;
+    case Op::_ANNN:
+        set_u16(I_.data(), nnn, mask16, lanes);
+        break;
+    case Op::_FX07:
+        logic_u8(Logic::copy, V_[x].data(), delay_.data(), mask8, lanes);
+        break;
+    case Op::_FX15:
+        logic_u8(Logic::copy, delay_.data(), V_[x].data(), mask8, lanes);
+        break;
+    case Op::_FX18:
+        logic_u8(Logic::copy, sound_.data(), V_[x].data(), mask8, lanes);
+        break;
+    default:
+        break;
+    }
+
+    set_u8(bad_opcode_.data(), 0x0, mask8, lanes);
+    if (decode(opcode) == Op::_1NNN) {
+        set_u16(pc_.data(), nnn, mask16, lanes);
+    } else {
+        add_u16(pc_.data(), 2, mask16, lanes);
+    }
+}
+
+// runs one instruction of @param lane through its Chip8
+void Lockstep::scalar_cycle(u32 lane) noexcept {
+    auto &state = machines_[lane].state_;
+    for (auto reg = 0u; reg < 16; ++reg) {
+        state.V[reg] = V_[reg][lane];
+    }
+    state.I = I_[lane];
+    state.pc = pc_[lane];
+    state.delay = delay_[lane];
+    state.sound = sound_[lane];
+    state.bad_opcode = bad_opcode_[lane];
+
+    // record the addresses the instruction stores to
+    const auto &memory = machines_[lane].memory();
+    const u16 opcode = (memory[state.pc] << 8) + memory[state.pc + 1];
+    auto stored = 0u;
+    if (decode(opcode) == Op::_FX33) {
+        stored = 3;
+    } else if (decode(opcode) == Op::_FX55) {
+        stored = nibble(nib::second, opcode) + 1u;
+    }
+    for (auto offset = 0u; offset < stored; ++offset) {
+        written_.set((state.I + offset) % Chip8::MEMORY_SIZE);
+    }
+
+    machines_[lane].cycle();
+
+    for (auto reg = 0u; reg < 16; ++reg) {
+        V_[reg][lane] = state.V[reg];
+    }
+    I_[lane] = state.I;
+    pc_[lane] = state.pc;
+    delay_[lane] = state.delay;
+    sound_[lane] = state.sound;
+    bad_opcode_[lane] = state.bad_opcode;
+}
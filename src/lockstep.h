@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <vector>
+
+#include "chip8.h"
+#include "common.h"
+
+/// Runs many copies of one Chip8 program in lockstep, keeping the registers
+/// of every copy (lane) in structure of arrays form.
+///
+/// Each step executes one instruction on every lane. The lanes whose pc
+/// matches the leading lane form a group, and the register instructions
+/// (1NNN, 6XNN, 7XNN, 8XY0 to 8XY3, ANNN, FX07, FX15, FX18) run for the
+/// whole group at once with SIMD, using AVX2 when the host has it. Any other
+/// instruction, and every lane outside the group, takes the scalar path
+/// through a per lane Chip8. A lane which diverged rejoins the group as
+/// soon as its pc matches again.
+class Lockstep {
+  public:
+    struct Stats {
+        // lane instructions executed on the vector path
+        u64 vector_instructions = 0;
+        // lane instructions executed one lane at a time
+        u64 scalar_instructions = 0;
+    };
+
+    /// starts @param lanes copies of @param initial
+    Lockstep(const Chip8::State &initial, u32 lanes);
+
+    u32 lanes() const noexcept { return lane_count_; }
+
+    /// replaces the state of @param lane, e.g. to give it different inputs
+    void set_state(u32 lane, const Chip8::State &state) noexcept;
+    /// returns the complete state of @param lane
+    Chip8::State state(u32 lane) const noexcept;
+
+    /// runs every lane for up to @param cycles instructions, returns how
+    /// many steps ran. Lanes whose pc runs off the end of memory halt, and
+    /// the run stops early once all of them have
+    u32 run(u32 cycles) noexcept;
+
+    /// decrements the delay and sound timers of every lane
+    void tick_timers() noexcept;
+
+    Stats stats() const noexcept { return stats_; }
+
+  private:
+    // lanes are processed in blocks of this many, the arrays are padded
+    static constexpr u32 BLOCK = 32;
+
+    u32 lane_count_;
+    // lane_count_ rounded up to a multiple of BLOCK
+    u32 padded_count_;
+
+    // registers, one entry per lane. Padding lanes have pc 0xFFFF so they
+    // never match a group
+    std::array<std::vector<u8>, 16> V_;
+    std::vector<u16> I_;
+    std::vector<u16> pc_;
+    std::vector<u8> delay_;
+    std::vector<u8> sound_;
+    std::vector<u8> bad_opcode_;
+
+    // memory, screen and stack of each lane, their registers are only
+    // current while the lane takes the scalar path. Lanes share the pages of
+    // memory they have not stored to
+    std::vector<SharedChip8> machines_;
+
+    // group membership of the current step, 0xFF / 0xFFFF for members
+    std::vector<u8> mask8_;
+    std::vector<u16> mask16_;
+    // lane whose pc the group follows
+    u32 leader_ = 0;
+
+    // addresses any lane has stored to. Opcodes fetched from anywhere else
+    // are the same for every lane
+    std::bitset<Chip8::MEMORY_SIZE> written_;
+
+    Stats stats_;
+
+    bool step() noexcept;
+    void execute_group(u16 opcode) noexcept;
+    void scalar_cycle(u32 lane) noexcept;
+};
@@ -1,13 +1,127 @@
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
 #include "SDL.h"
 #include "chip8.h"
 #include "emu.h"
 #include "spdlog/spdlog.h"
 
-int main(int argc, char *argv[]) {
+namespace {
+
+struct Options {
+    std::string_view rom{"ibm_logo.ch8"};
+    EmuBase::MovieMode movie_mode = EmuBase::MovieMode::none;
+    std::string_view movie;
+    bool turbo = false;
+    u32 frame_skip = 0;
+    u32 instructions_per_frame = 10;
+    AudioConfig audio;
+};
 
-    Emu emu{16, Emu::State::Debug};
+template <typename Core> int run(const Options &options) {
+    // the same window for every screen size
+    constexpr auto screen_scale = static_cast<u8>(1024 / Core::SCREEN_WIDTH);
+    Emu<Core> emu{screen_scale, EmuBase::State::Debug, options.audio};
+    emu.set_instructions_per_frame(options.instructions_per_frame);
+    emu.set_turbo(options.turbo);
+    emu.set_frame_skip(options.frame_skip);
 
-    const auto rom = emu.load_rom_file("ibm_logo.ch8");
+    if (!emu.load_rom_file(options.rom)) {
+        return 1;
+    }
+    if (options.movie_mode == EmuBase::MovieMode::record) {
+        emu.record_movie(options.movie);
+    } else if (options.movie_mode == EmuBase::MovieMode::replay &&
+               !emu.replay_movie(options.movie)) {
+        return 1;
+    }
 
     emu.run();
+    return 0;
+}
+
+// runs the build of @tparam Variant for the quirks named @param quirks, the
+// variant's own when empty, out of the profiles @tparam Quirks it is built
+// for
+template <typename Variant, typename Quirks, typename... Others>
+int run_profile(const Options &options, std::string_view quirks) {
+    if (quirks.empty() ? std::is_same_v<Quirks, typename Variant::Quirks>
+                       : quirks == Quirks::NAME) {
+        return run<Chip8Core<Variant, Quirks>>(options);
+    }
+    if constexpr (sizeof...(Others) > 0) {
+        return run_profile<Variant, Others...>(options, quirks);
+    }
+    spdlog::error("{} is not built with the {} quirks", Variant::NAME, quirks);
+    return 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto options = Options{};
+    auto variant = std::string_view{variant::Chip8::NAME};
+    auto quirks = std::string_view{};
+    for (auto i = 1; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        const auto has_value = i + 1 < argc;
+        if ((arg == "--record" || arg == "--replay") && has_value) {
+            options.movie_mode = arg == "--record"
+                                     ? EmuBase::MovieMode::record
+                                     : EmuBase::MovieMode::replay;
+            options.movie = argv[++i];
+        } else if (arg == "--turbo") {
+            options.turbo = true;
+        } else if (arg == "--skip" && has_value) {
+            options.frame_skip = static_cast<u32>(std::stoul(argv[++i]));
+        } else if (arg == "--ipf" && has_value) {
+            options.instructions_per_frame =
+                static_cast<u32>(std::stoul(argv[++i]));
+        } else if (arg == "--audio-buffer" && has_value) {
+            options.audio.buffer_samples =
+                static_cast<u32>(std::stoul(argv[++i]));
+        } else if (arg == "--variant" && has_value) {
+            variant = argv[++i];
+        } else if (arg == "--quirks" && has_value) {
+            quirks = argv[++i];
+        } else if (!arg.starts_with("--")) {
+            options.rom = arg;
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [rom] [--record FILE | --replay FILE] "
+                         "[--ipf N] [--turbo] [--skip N] "
+                         "[--variant chip8|schip|xochip] "
+                         "[--quirks modern|cosmac|schip|xochip] "
+                         "[--audio-buffer N]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    // SDL takes the buffer size as a u16
+    if (options.audio.buffer_samples == 0 ||
+        options.audio.buffer_samples > std::numeric_limits<u16>::max()) {
+        spdlog::error("Audio buffers hold 1 to {} samples",
+                      std::numeric_limits<u16>::max());
+        return 1;
+    }
+
+    // CHIP-8 ROMs were written for interpreters with every set of quirks,
+    // the larger machines only run their own
+    if (variant == variant::Chip8::NAME) {
+        return run_profile<variant::Chip8, quirks::Modern, quirks::Cosmac,
+                           quirks::SuperChip, quirks::XoChip>(options, quirks);
+    }
+    if (variant == variant::SuperChip::NAME) {
+        return run_profile<variant::SuperChip, quirks::SuperChip>(options,
+                                                                  quirks);
+    }
+    if (variant == variant::XoChip::NAME) {
+        return run_profile<variant::XoChip, quirks::XoChip>(options, quirks);
+    }
+    spdlog::error("Unknown variant {}", variant);
+    return 1;
 }
@@ -0,0 +1,135 @@
+#include "movie.h"
+
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <string_view>
+
+#include "spdlog/spdlog.h"
+
+#include "binary_io.h"
+
+namespace {
+
+struct Run {
+    u16 keys;
+    u16 frames;
+};
+
+void write_name(std::ostream &out, std::string_view name) {
+    write_field(out, static_cast<u8>(name.size()));
+    out.write(name.data(), static_cast<std::streamsize>(name.size()));
+}
+
+void read_name(std::istream &in, std::string &name) {
+    auto size = u8{0};
+    read_field(in, size);
+    name.resize(size);
+    in.read(name.data(), size);
+}
+
+void write_header(std::ostream &out, const MovieFileHeader &header) {
+    write_field(out, header.magic);
+    write_field(out, header.version);
+    write_field(out, header.rom_hash);
+    write_field(out, header.instructions_per_frame);
+    write_field(out, header.frames);
+    write_field(out, header.runs);
+    write_name(out, header.variant);
+    write_name(out, header.quirks);
+}
+
+// reads the header up to the version, and the rest only if the version is
+// the current one
+void read_header(std::istream &in, MovieFileHeader &header) {
+    read_field(in, header.magic);
+    read_field(in, header.version);
+    if (!in || header.version != MOVIE_FILE_VERSION) {
+        return;
+    }
+    read_field(in, header.rom_hash);
+    read_field(in, header.instructions_per_frame);
+    read_field(in, header.frames);
+    read_field(in, header.runs);
+    read_name(in, header.variant);
+    read_name(in, header.quirks);
+}
+
+} // namespace
+
+bool write_movie_file(const std::filesystem::path &path, const Movie &movie) {
+    // keys mostly stay the same for many frames, so store runs of them
+    std::vector<Run> runs;
+    for (const auto keys : movie.keys) {
+        if (runs.empty() || runs.back().keys != keys ||
+            runs.back().frames == std::numeric_limits<u16>::max()) {
+            runs.push_back({keys, 0});
+        }
+        ++runs.back().frames;
+    }
+
+    auto header = MovieFileHeader{};
+    header.rom_hash = movie.rom_hash;
+    header.instructions_per_frame = movie.instructions_per_frame;
+    header.frames = movie.frames();
+    header.runs = static_cast<u32>(runs.size());
+    header.variant = movie.variant;
+    header.quirks = movie.quirks;
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    write_header(file, header);
+    for (const auto &run : runs) {
+        write_field(file, run.keys);
+        write_field(file, run.frames);
+    }
+
+    if (!file) {
+        spdlog::error("Movie File: could not write {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+std::optional<Movie> read_movie_file(const std::filesystem::path &path) {
+    std::ifstream file{path, std::ios::binary};
+    auto header = MovieFileHeader{};
+    read_header(file, header);
+    if (!file) {
+        spdlog::error("Movie File: could not read {}", path.string());
+        return std::nullopt;
+    }
+
+    const auto expected = MovieFileHeader{};
+    if (header.magic != expected.magic) {
+        spdlog::error("Movie File: {} is not a movie file", path.string());
+        return std::nullopt;
+    }
+    if (header.version != expected.version) {
+        spdlog::error("Movie File: {} has version {}, expected version {}",
+                      path.string(), header.version, expected.version);
+        return std::nullopt;
+    }
+
+    auto movie = Movie{};
+    movie.rom_hash = header.rom_hash;
+    movie.instructions_per_frame = header.instructions_per_frame;
+    movie.variant = header.variant;
+    movie.quirks = header.quirks;
+    for (auto i = 0u; i < header.runs; ++i) {
+        auto run = Run{};
+        read_field(file, run.keys);
+        read_field(file, run.frames);
+        if (!file) {
+            spdlog::error("Movie File: {} is truncated", path.string());
+            return std::nullopt;
+        }
+        movie.keys.insert(movie.keys.end(), run.frames, run.keys);
+    }
+    if (movie.frames() != header.frames) {
+        spdlog::error("Movie File: {} holds {} frames, its header says {}",
+                      path.string(), movie.frames(), header.frames);
+        return std::nullopt;
+    }
+    return movie;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "chip8.h"
+#include "common.h"
+
+// On disk a movie is the fields of a MovieFileHeader one after the other,
+// each name as a u8 length and its characters, followed by header.runs runs
+// of frames with the same keypad state, each a u16 of keys and a u16 frame
+// count, in host byte order.
+
+inline constexpr u32 MOVIE_FILE_VERSION = 2;
+
+struct MovieFileHeader {
+    std::array<char, 4> magic = {'C', '8', 'M', 'V'};
+    u32 version = MOVIE_FILE_VERSION;
+    u64 rom_hash = 0;
+    u32 instructions_per_frame = 0;
+    u32 frames = 0;
+    u32 runs = 0;
+    // names of the variant and the quirks of the recording core
+    std::string variant;
+    std::string quirks;
+};
+
+/// The keypad state of every frame of a run. Replaying it from power on with
+/// the same ROM, core and instructions per frame repeats the run bit for bit.
+struct Movie {
+    // fnv1a hash of the ROM it was recorded with
+    u64 rom_hash = 0;
+    u32 instructions_per_frame = 10;
+    // Chip8Core::VARIANT and Chip8Core::QUIRKS of the core it was recorded on
+    std::string variant{Chip8::VARIANT};
+    std::string quirks{Chip8::QUIRKS};
+    // held keys of each frame, bit k for key k
+    std::vector<u16> keys;
+
+    u32 frames() const noexcept { return static_cast<u32>(keys.size()); }
+};
+
+/// true if @param movie was recorded on a core with the variant and quirks
+/// of @tparam Core, which a replay needs to repeat it
+template <typename Core> bool recorded_on(const Movie &movie) noexcept {
+    return movie.variant == Core::VARIANT && movie.quirks == Core::QUIRKS;
+}
+
+/// runs one frame the way movies are recorded and replayed: sets @param keys,
+/// runs @param instructions_per_frame instructions and ticks the timers.
+/// Returns the instructions executed, fewer if the pc ran off the end of
+/// memory in which case the timers are left alone
+template <typename Core>
+u32 run_frame(Core &chip8, u16 keys, u32 instructions_per_frame) noexcept {
+    chip8.set_keys(keys);
+    const auto executed = chip8.run(instructions_per_frame);
+    if (executed == instructions_per_frame) {
+        chip8.tick_timers();
+    }
+    return executed;
+}
+
+/// replays every frame of @param movie as fast as possible, returns the
+/// instructions executed. Stops early if the pc runs off the end of memory
+template <typename Core>
+u64 play_movie(Core &chip8, const Movie &movie) noexcept {
+    u64 executed = 0;
+    for (const auto keys : movie.keys) {
+        const auto frame = run_frame(chip8, keys, movie.instructions_per_frame);
+        executed += frame;
+        if (frame < movie.instructions_per_frame) {
+            break;
+        }
+    }
+    return executed;
+}
+
+/// writes @param movie to @param path, returns false on failure
+bool write_movie_file(const std::filesystem::path &path, const Movie &movie);
+
+/// reads a movie written by write_movie_file, returns std::nullopt if the
+/// file can not be read or was written by another version
+std::optional<Movie> read_movie_file(const std::filesystem::path &path);
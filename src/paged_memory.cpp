@@ -0,0 +1,66 @@
+#include "paged_memory.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+template <u32 Size>
+const std::shared_ptr<const typename BasicPagedMemory<Size>::Image> &
+zero_image() {
+    static const auto image =
+        std::make_shared<const typename BasicPagedMemory<Size>::Image>();
+    return image;
+}
+
+} // namespace
+
+template <u32 Size> BasicPagedMemory<Size>::BasicPagedMemory() noexcept {
+    share(zero_image<Size>());
+}
+
+template <u32 Size>
+void BasicPagedMemory<Size>::share(
+    std::shared_ptr<const Image> image) noexcept {
+    image_ = std::move(image);
+    for (auto page = 0u; page < PAGE_COUNT; ++page) {
+        private_[page].reset();
+        pages_[page] = image_->data() + page * PAGE_SIZE;
+    }
+}
+
+template <u32 Size>
+void BasicPagedMemory<Size>::assign(std::span<const u8, SIZE> bytes) {
+    for (auto page = 0u; page < PAGE_COUNT; ++page) {
+        const auto source = bytes.subspan(page * PAGE_SIZE, PAGE_SIZE);
+        if (std::ranges::equal(source, std::span{pages_[page], PAGE_SIZE})) {
+            continue;
+        }
+        if (!private_[page]) {
+            make_private(page);
+        }
+        std::ranges::copy(source, private_[page]->begin());
+    }
+}
+
+template <u32 Size>
+void BasicPagedMemory<Size>::copy_to(std::span<u8, SIZE> bytes) const noexcept {
+    for (auto page = 0u; page < PAGE_COUNT; ++page) {
+        std::copy_n(pages_[page], PAGE_SIZE, bytes.begin() + page * PAGE_SIZE);
+    }
+}
+
+template <u32 Size>
+u32 BasicPagedMemory<Size>::private_pages() const noexcept {
+    return static_cast<u32>(std::ranges::count_if(
+        private_, [](const auto &page) { return page != nullptr; }));
+}
+
+template <u32 Size> void BasicPagedMemory<Size>::make_private(u32 page) {
+    private_[page] = std::make_unique<Page>();
+    std::copy_n(pages_[page], PAGE_SIZE, private_[page]->begin());
+    pages_[page] = private_[page]->data();
+}
+
+template class BasicPagedMemory<4096>;
+template class BasicPagedMemory<65536>;
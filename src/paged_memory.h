@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <span>
+
+#include "common.h"
+
+/// Chip8 memory of @tparam Size bytes split into pages, the memory model of
+/// SharedChip8. Pages start out pointing into an image shared read only
+/// between instances and get a private copy on their first write, so many
+/// instances of one ROM only pay for the pages they store to. Every access
+/// goes through the page table, and the copy is allocated inside the core's
+/// noexcept stores, so running out of memory there terminates. A single
+/// instance is better off with FlatMemory.
+template <u32 Size> class BasicPagedMemory {
+  public:
+    static constexpr u32 SIZE = Size;
+    static constexpr u32 PAGE_SIZE = 256;
+    static constexpr u32 PAGE_COUNT = SIZE / PAGE_SIZE;
+
+    using Page = std::array<u8, PAGE_SIZE>;
+    /// complete contents of memory, shared between instances
+    using Image = std::array<u8, SIZE>;
+
+    /// every page starts out sharing one page of zeros
+    BasicPagedMemory() noexcept;
+
+    u8 operator[](u32 address) const noexcept {
+        address %= SIZE;
+        return pages_[address / PAGE_SIZE][address % PAGE_SIZE];
+    }
+
+    /// stores @param value, copying the page first if it is still shared
+    void write(u32 address, u8 value) {
+        address %= SIZE;
+        const auto page = address / PAGE_SIZE;
+        if (!private_[page]) {
+            make_private(page);
+        }
+        (*private_[page])[address % PAGE_SIZE] = value;
+    }
+
+    /// drops every private page and shares all of @param image
+    void share(std::shared_ptr<const Image> image) noexcept;
+    /// replaces the contents with @param bytes. Pages already holding the
+    /// same bytes are left alone, so they stay shared
+    void assign(std::span<const u8, SIZE> bytes);
+    /// copies the contents to @param bytes
+    void copy_to(std::span<u8, SIZE> bytes) const noexcept;
+
+    /// number of pages with a private copy
+    u32 private_pages() const noexcept;
+
+  private:
+    // where each page is read from, either the shared image or private_
+    std::array<const u8 *, PAGE_COUNT> pages_;
+    std::array<std::unique_ptr<Page>, PAGE_COUNT> private_;
+    // keeps the shared image alive
+    std::shared_ptr<const Image> image_;
+
+    void make_private(u32 page);
+};
+
+/// the 4 KB memory of CHIP-8 and SUPER-CHIP
+using PagedMemory = BasicPagedMemory<4096>;
+
+extern template class BasicPagedMemory<4096>;
+extern template class BasicPagedMemory<65536>;
@@ -0,0 +1,119 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+#include "spdlog/fmt/fmt.h"
+
+void Profiler::record(u16 pc, u16 opcode, std::span<const u16> stack,
+                      u64 count) noexcept {
+    // the stack moves by at most one frame per instruction, a call shows up
+    // as one more frame with the pc at the entry of the routine
+    const auto depth = static_cast<u32>(stack.size());
+    while (nodes_[current_].depth > depth) {
+        current_ = nodes_[current_].parent;
+    }
+    if (nodes_[current_].depth + 1 == depth) {
+        current_ = child(current_, pc);
+    }
+    while (nodes_[current_].depth < depth) {
+        // the state was replaced, the routines of these frames are unknown
+        current_ = child(current_, UNKNOWN_ROUTINE);
+    }
+
+    total_ += count;
+    per_pc_[pc % per_pc_.size()] += count;
+    per_op_[static_cast<u32>(decode_(opcode))] += count;
+    nodes_[current_].executed += count;
+}
+
+void Profiler::reset() {
+    total_ = 0;
+    std::ranges::fill(per_pc_, 0);
+    per_op_.fill(0);
+    nodes_.clear();
+    nodes_.push_back(Node{0, 0, 0, 0, {}});
+    current_ = 0;
+}
+
+u32 Profiler::child(u32 parent, u16 routine) {
+    for (const auto index : nodes_[parent].children) {
+        if (nodes_[index].routine == routine) {
+            return index;
+        }
+    }
+    const auto index = static_cast<u32>(nodes_.size());
+    nodes_.push_back(Node{routine, parent, nodes_[parent].depth + 1, 0, {}});
+    nodes_[parent].children.push_back(index);
+    return index;
+}
+
+std::string Profiler::path(u32 node) const {
+    std::vector<u32> frames;
+    for (; node != 0; node = nodes_[node].parent) {
+        frames.push_back(node);
+    }
+    auto text = std::string{"main"};
+    for (auto it = frames.rbegin(); it != frames.rend(); ++it) {
+        const auto routine = nodes_[*it].routine;
+        text += routine == UNKNOWN_ROUTINE ? std::string{";?"}
+                                           : fmt::format(";0x{:03X}", routine);
+    }
+    return text;
+}
+
+void Profiler::write_folded(std::ostream &out) const {
+    for (auto node = 0u; node < nodes_.size(); ++node) {
+        if (nodes_[node].executed > 0) {
+            out << path(node) << ' ' << nodes_[node].executed << '\n';
+        }
+    }
+}
+
+namespace {
+
+// indices of the @param top largest entries of @param counts, largest first
+template <typename Counts>
+std::vector<u32> largest(const Counts &counts, u32 top) {
+    std::vector<u32> indices(counts.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    const auto count = std::min<std::size_t>(top, indices.size());
+    std::partial_sort(
+        indices.begin(), indices.begin() + count, indices.end(),
+        [&counts](u32 a, u32 b) { return counts[a] > counts[b]; });
+    indices.resize(count);
+    std::erase_if(indices, [&counts](u32 i) { return counts[i] == 0; });
+    return indices;
+}
+
+} // namespace
+
+void Profiler::write_report(std::ostream &out, u32 top) const {
+    const auto percent = [this](u64 count) {
+        return total_ == 0 ? 0.0 : 100.0 * static_cast<double>(count) /
+                                       static_cast<double>(total_);
+    };
+
+    out << fmt::format("{} instructions\n\npc     executed      %\n", total_);
+    for (const auto pc : largest(per_pc_, top)) {
+        out << fmt::format("0x{:03X} {:>12} {:>6.2f}\n", pc, per_pc_[pc],
+                           percent(per_pc_[pc]));
+    }
+
+    out << "\ninstruction  executed      %\n";
+    for (const auto op : largest(per_op_, top)) {
+        out << fmt::format("{:<6} {:>14} {:>6.2f}\n",
+                           op_name(static_cast<Op>(op)), per_op_[op],
+                           percent(per_op_[op]));
+    }
+
+    std::vector<u64> executed(nodes_.size());
+    std::ranges::transform(nodes_, executed.begin(),
+                           [](const Node &node) { return node.executed; });
+    out << "\npath executed      %\n";
+    for (const auto node : largest(executed, top)) {
+        out << fmt::format("{} {} {:.2f}\n", path(node), executed[node],
+                           percent(executed[node]));
+    }
+}
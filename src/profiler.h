@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "common.h"
+#include "decode.h"
+
+// Profiling of the instructions a Chip8 executes.
+//
+// Compiled in with CHIP8_PROFILE=1, otherwise the hook in Chip8::cycle is
+// removed entirely. When compiled in it costs a pointer test per instruction
+// until a Profiler is attached with Chip8::set_profiler.
+
+#ifndef CHIP8_PROFILE
+#define CHIP8_PROFILE 0
+#endif
+
+namespace profile {
+inline constexpr bool COMPILED = CHIP8_PROFILE != 0;
+} // namespace profile
+
+/// Counts executions per pc, per instruction and per call stack path.
+class Profiler {
+  public:
+    using Decoder = Op (*)(u16 opcode) noexcept;
+
+    /// counts the pcs of @param memory_size bytes of memory and the
+    /// instructions @param decode finds
+    Profiler(u32 memory_size, Decoder decode)
+        : per_pc_(memory_size), decode_{decode} {
+        reset();
+    }
+
+    /// a Profiler for the cores of @tparam Variant
+    template <typename Variant> static Profiler for_variant() {
+        return Profiler{Variant::MEMORY_SIZE, &Variant::decode};
+    }
+
+    /// counts @param count executions of @param opcode at @param pc with the
+    /// return addresses @param stack
+    void record(u16 pc, u16 opcode, std::span<const u16> stack,
+                u64 count = 1) noexcept;
+
+    void reset();
+
+    u64 total() const noexcept { return total_; }
+    u64 at(u16 pc) const noexcept { return per_pc_[pc % per_pc_.size()]; }
+    u64 of(Op op) const noexcept { return per_op_[static_cast<u32>(op)]; }
+
+    /// writes one line per call stack path, the routines from the outermost
+    /// call in and the instructions executed in the innermost, the folded
+    /// format flamegraph.pl and speedscope read
+    void write_folded(std::ostream &out) const;
+    /// writes the @param top pcs, instructions and paths by executions
+    void write_report(std::ostream &out, u32 top = 20) const;
+
+  private:
+    // a routine reached through one path of calls
+    struct Node {
+        // entry address, UNKNOWN_ROUTINE if the call was not seen
+        u16 routine;
+        u32 parent;
+        u32 depth;
+        // instructions executed in this routine, not in its callees
+        u64 executed = 0;
+        std::vector<u32> children;
+    };
+    static constexpr u16 UNKNOWN_ROUTINE = 0xFFFF;
+
+    u64 total_ = 0;
+    std::vector<u64> per_pc_;
+    std::array<u64, OP_COUNT> per_op_;
+    Decoder decode_;
+    // nodes_[0] is the code outside any call
+    std::vector<Node> nodes_;
+    u32 current_ = 0;
+
+    u32 child(u32 parent, u16 routine);
+    std::string path(u32 node) const;
+};
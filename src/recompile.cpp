@@ -0,0 +1,74 @@
+// Ahead of time recompiler: translates a .ch8 file into a C++ translation
+// unit defining an AotProgram, to be compiled into the binary running it and
+// attached with Chip8::set_program.
+
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "spdlog/spdlog.h"
+
+#include "chip8.h"
+#include "recompiler.h"
+#include "rom.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+void print_usage(const char *program) {
+    std::fprintf(stderr, "usage: %s <rom.ch8> <out.cpp> [--name NAME]\n",
+                 program);
+}
+
+// the file name of @param path as an identifier
+std::string identifier(const fs::path &path) {
+    auto name = path.stem().string();
+    for (auto &c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c))) {
+            c = '_';
+        }
+    }
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0]))) {
+        name.insert(0, "rom_");
+    }
+    return name;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (argc != 3 && argc != 5) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    const fs::path rom_path = argv[1];
+    const fs::path out_path = argv[2];
+    auto name = identifier(rom_path);
+    if (argc == 5) {
+        if (std::string_view{argv[3]} != "--name") {
+            print_usage(argv[0]);
+            return 1;
+        }
+        name = argv[4];
+    }
+
+    // translation is CHIP-8 only
+    const auto rom = MappedRom::open(rom_path, Chip8::MAX_ROM_SIZE);
+    if (rom.empty()) {
+        return 1;
+    }
+    const auto blocks = recompiler::find_blocks(rom.bytes());
+
+    std::ofstream out{out_path};
+    out << recompiler::translate(rom.bytes(), blocks, name);
+    if (!out) {
+        spdlog::error("Could not write {}", out_path.string());
+        return 1;
+    }
+    spdlog::info("Translated {} blocks of {} into {}", blocks.size(),
+                 rom_path.string(), out_path.string());
+}
@@ -0,0 +1,227 @@
+#include "recompiler.h"
+
+#include <algorithm>
+
+#include "spdlog/fmt/fmt.h"
+
+#include "analysis.h"
+#include "chip8.h"
+#include "decode.h"
+
+namespace recompiler {
+
+namespace {
+
+/// The ROM as loaded at ROM_START, anything past MAX_ROM_SIZE is cut off.
+/// Only CHIP-8 is translated, so that is the CHIP-8 limit whatever the ROM
+/// was written for.
+class Image {
+  public:
+    explicit Image(std::span<const u8> rom)
+        : rom_{rom.first(
+              std::min<std::size_t>(rom.size(), Chip8::MAX_ROM_SIZE))} {}
+
+    std::span<const u8> bytes() const noexcept { return rom_; }
+    /// true if both bytes of an instruction at @param address are in the ROM
+    bool holds(u32 address) const noexcept {
+        return address >= Chip8::ROM_START &&
+               address + 2 <= Chip8::ROM_START + rom_.size();
+    }
+    u16 opcode(u32 address) const noexcept {
+        const auto offset = address - Chip8::ROM_START;
+        return static_cast<u16>((rom_[offset] << 8) + rom_[offset + 1]);
+    }
+
+  private:
+    std::span<const u8> rom_;
+};
+
+// the instructions whose stores can hit a block
+constexpr bool writes_memory(Op op) noexcept {
+    return op == Op::_FX33 || op == Op::_FX55;
+}
+
+// returns the statement executing @param opcode inline, empty if it is left
+// to Chip8::execute
+std::string inline_statement(u16 opcode, u16 next) {
+    const auto X = nibble(nib::second, opcode);
+    const auto Y = nibble(nib::third, opcode);
+    const auto NN = opcode & 0x00FF;
+    const auto NNN = opcode & 0x0FFF;
+    const auto skip = next + 2;
+    switch (decode(opcode)) {
+    case Op::_00E0:
+        return "m.screen.fill(0x0);";
+    case Op::_00EE:
+        return fmt::format("if (m.sp == 0) {{\n"
+                           "        m.stack_fault = true;\n"
+                           "        m.pc = 0x{:03X};\n"
+                           "    }} else {{\n"
+                           "        m.pc = m.stack[--m.sp];\n"
+                           "    }}",
+                           next);
+    case Op::_1NNN:
+        return fmt::format("m.pc = 0x{:03X};", NNN);
+    case Op::_2NNN:
+        return fmt::format("if (m.sp == Chip8::STACK_SIZE) {{\n"
+                           "        m.stack_fault = true;\n"
+                           "        m.pc = 0x{0:03X};\n"
+                           "    }} else {{\n"
+                           "        m.stack[m.sp++] = 0x{0:03X};\n"
+                           "        m.pc = 0x{1:03X};\n"
+                           "    }}",
+                           next, NNN);
+    case Op::_3XNN:
+        return fmt::format(
+            "m.pc = m.V[0x{:X}] == 0x{:02X} ? 0x{:03X} : 0x{:03X};", X, NN,
+            skip, next);
+    case Op::_4XNN:
+        return fmt::format(
+            "m.pc = m.V[0x{:X}] != 0x{:02X} ? 0x{:03X} : 0x{:03X};", X, NN,
+            skip, next);
+    case Op::_6XNN:
+        return fmt::format("m.V[0x{:X}] = 0x{:02X};", X, NN);
+    case Op::_7XNN:
+        return fmt::format("m.V[0x{:X}] += 0x{:02X};", X, NN);
+    case Op::_8XY0:
+        return fmt::format("m.V[0x{:X}] = m.V[0x{:X}];", X, Y);
+    case Op::_8XY1:
+        return fmt::format("m.V[0x{:X}] |= m.V[0x{:X}];", X, Y);
+    case Op::_8XY2:
+        return fmt::format("m.V[0x{:X}] &= m.V[0x{:X}];", X, Y);
+    case Op::_8XY3:
+        return fmt::format("m.V[0x{:X}] ^= m.V[0x{:X}];", X, Y);
+    case Op::_8XY6:
+        return fmt::format("{{\n"
+                           "        const u8 value = m.V[0x{0:X}];\n"
+                           "        m.V[0x{0:X}] = value >> 1;\n"
+                           "        m.V[0xF] = value & 0x1;\n"
+                           "    }}",
+                           X);
+    case Op::_8XYE:
+        return fmt::format(
+            "{{\n"
+            "        const u8 value = m.V[0x{0:X}];\n"
+            "        m.V[0x{0:X}] = static_cast<u8>(value << 1);\n"
+            "        m.V[0xF] = value >> 7;\n"
+            "    }}",
+            X);
+    case Op::_ANNN:
+        return fmt::format("m.I = 0x{:03X};", NNN);
+    case Op::_EX9E:
+        return fmt::format("m.pc = (m.keys >> (m.V[0x{:X}] & 0xF)) & 0x1 ? "
+                           "0x{:03X} : 0x{:03X};",
+                           X, skip, next);
+    case Op::_EXA1:
+        return fmt::format("m.pc = (m.keys >> (m.V[0x{:X}] & 0xF)) & 0x1 ? "
+                           "0x{:03X} : 0x{:03X};",
+                           X, next, skip);
+    case Op::_FX07:
+        return fmt::format("m.V[0x{:X}] = m.delay;", X);
+    case Op::_FX15:
+        return fmt::format("m.delay = m.V[0x{:X}];", X);
+    case Op::_FX18:
+        return fmt::format("m.sound = m.V[0x{:X}];", X);
+    case Op::_0NNN:
+    case Op::unknown:
+        return "m.bad_opcode = true;";
+    default:
+        return {};
+    }
+}
+
+void translate_block(const Image &image, const Block &block,
+                     std::string &out) {
+    out += fmt::format(
+        "// {:03X}-{:03X}\n"
+        "u32 block_{:03X}(Machine &m, [[maybe_unused]] Aot &aot) noexcept {{\n",
+        block.start, block.end, block.start);
+    // bad_opcode is left by the last instruction, execute() clears it
+    auto maybe_bad = true;
+    auto pc_set = false;
+    auto executed = 0u;
+    for (auto address = block.start; address < block.end; address += 2) {
+        const auto opcode = image.opcode(address);
+        const auto op = decode(opcode);
+        const auto next = static_cast<u16>(address + 2);
+        ++executed;
+        out += fmt::format("    // {:03X}: {:04X} {}\n", address, opcode,
+                           op_name(op));
+
+        const auto statement = inline_statement(opcode, next);
+        if (statement.empty()) {
+            out += fmt::format("    m.pc = 0x{:03X};\n", next);
+            if (writes_memory(op)) {
+                out += fmt::format("    if (aot.execute(0x{:04X})) {{\n"
+                                   "        return {};\n"
+                                   "    }}\n",
+                                   opcode, executed);
+            } else {
+                out += fmt::format("    aot.execute(0x{:04X});\n", opcode);
+            }
+            maybe_bad = false;
+            pc_set = true;
+            continue;
+        }
+        const auto bad = op == Op::_0NNN || op == Op::unknown;
+        if (maybe_bad && !bad) {
+            out += "    m.bad_opcode = false;\n";
+        }
+        out += fmt::format("    {}\n", statement);
+        maybe_bad = bad;
+        pc_set = ends_block(op);
+    }
+    if (!pc_set) {
+        out += fmt::format("    m.pc = 0x{:03X};\n", block.end);
+    }
+    out += fmt::format("    return {};\n}}\n\n", executed);
+}
+
+} // namespace
+
+std::vector<Block> find_blocks(std::span<const u8> rom) {
+    std::vector<Block> blocks;
+    for (const auto &block : analysis::analyze(rom).blocks) {
+        blocks.push_back({block.start, block.end, block.length});
+    }
+    return blocks;
+}
+
+std::string translate(std::span<const u8> rom, std::span<const Block> blocks,
+                      std::string_view name) {
+    const Image image{rom};
+
+    auto out =
+        fmt::format("// {} translated by chip8_recompile, do not edit\n\n"
+                    "#include \"aot.h\"\n\n"
+                    "namespace {{\n\n"
+                    "using Machine = Chip8::Machine;\n\n"
+                    "constexpr u8 ROM[] = {{",
+                    name);
+    const auto bytes = image.bytes();
+    for (auto i = 0u; i < bytes.size(); ++i) {
+        out += i % 12 == 0 ? "\n   " : "";
+        out += fmt::format(" 0x{:02X},", bytes[i]);
+    }
+    out += "\n};\n\n";
+
+    for (const auto &block : blocks) {
+        translate_block(image, block, out);
+    }
+
+    if (!blocks.empty()) {
+        out += "constexpr AotBlock BLOCKS[] = {\n";
+        for (const auto &block : blocks) {
+            out += fmt::format(
+                "    {{0x{0:03X}, 0x{1:03X}, {2}, &block_{0:03X}}},\n",
+                block.start, block.end, block.length);
+        }
+        out += "};\n\n";
+    }
+    out += fmt::format("}} // namespace\n\n"
+                       "extern const AotProgram {0} = {{\"{0}\", ROM, {1}}};\n",
+                       name, blocks.empty() ? "{}" : "BLOCKS");
+    return out;
+}
+
+} // namespace recompiler
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common.h"
+
+// Ahead of time translation of a CHIP-8 ROM into C++.
+//
+// The basic blocks are the ones analysis::analyze finds reachable from
+// ROM_START, jump table entries included. Each basic block becomes one
+// function against Chip8::Machine, which chip8_recompile writes
+// into a translation unit defining an AotProgram (see aot.h) to be compiled
+// into the binary running the ROM. Register, I, timer and control flow
+// instructions are translated inline, the ones touching memory, the screen
+// or the keypad wait call back into Chip8::execute. BNNN ends a block and is
+// left to the interpreter, as is anything the analysis did not reach.
+// Translation assumes CHIP-8 with its default quirks.
+
+namespace recompiler {
+
+/// A straight line run of instructions, ending at the first one which can
+/// move the pc elsewhere or where another block starts.
+struct Block {
+    u16 start = 0x0;
+    // one past the last byte of the block
+    u16 end = 0x0;
+    // instructions in the block
+    u32 length = 0;
+
+    bool operator==(const Block &) const = default;
+};
+
+/// returns the blocks reachable from ROM_START in @param rom, by start
+/// address
+std::vector<Block> find_blocks(std::span<const u8> rom);
+
+/// returns a C++ translation unit defining the AotProgram @param name, a
+/// valid identifier, with @param blocks of @param rom, as find_blocks
+/// returns them, translated. The ROM must not be empty
+std::string translate(std::span<const u8> rom, std::span<const Block> blocks,
+                      std::string_view name);
+
+} // namespace recompiler
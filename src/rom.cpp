@@ -0,0 +1,113 @@
+#include "rom.h"
+
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+#include "spdlog/spdlog.h"
+
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+MappedRom::~MappedRom() { release(); }
+
+MappedRom::MappedRom(MappedRom &&other) noexcept { *this = std::move(other); }
+
+MappedRom &MappedRom::operator=(MappedRom &&other) noexcept {
+    if (this != &other) {
+        release();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        hash_ = std::exchange(other.hash_, 0);
+#if !defined(__unix__)
+        contents_ = std::move(other.contents_);
+#endif
+    }
+    return *this;
+}
+
+void MappedRom::release() noexcept {
+#if defined(__unix__)
+    if (data_) {
+        munmap(const_cast<u8 *>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+MappedRom MappedRom::open(const std::filesystem::path &path,
+                          std::size_t max_size) {
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    if (!fs::is_regular_file(path, error)) {
+        spdlog::error("Rom File: {} is not a regular file", path.string());
+        return {};
+    }
+    const auto size = fs::file_size(path, error);
+    if (error || size == 0 || size > max_size) {
+        spdlog::error("Rom File: {} has size {}, expected 1 to {} bytes",
+                      path.string(), error ? 0 : size, max_size);
+        return {};
+    }
+
+    MappedRom rom;
+#if defined(__unix__)
+    const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        spdlog::error("Rom File: {} could not be opened", path.string());
+        return {};
+    }
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        spdlog::error("Rom File: {} could not be mapped", path.string());
+        return {};
+    }
+    rom.data_ = static_cast<const u8 *>(mapped);
+#else
+    std::ifstream file{path, std::ios::binary};
+    rom.contents_.resize(size);
+    if (!file.read(reinterpret_cast<char *>(rom.contents_.data()),
+                   static_cast<std::streamsize>(size))) {
+        spdlog::error("Rom File: {} could not be read", path.string());
+        return {};
+    }
+    rom.data_ = rom.contents_.data();
+#endif
+    rom.size_ = size;
+    rom.hash_ = fnv1a(rom.bytes());
+
+    spdlog::debug("Rom {} size: {}", path.string(), size);
+    return rom;
+}
+
+std::shared_ptr<const MappedRom>
+RomLibrary::load(const std::filesystem::path &path) {
+    auto rom = MappedRom::open(path);
+    if (rom.empty()) {
+        return nullptr;
+    }
+
+    const std::lock_guard lock{mutex_};
+    const auto found = images_.find(rom.hash());
+    if (found != images_.end()) {
+        if (std::ranges::equal(found->second->bytes(), rom.bytes())) {
+            return found->second;
+        }
+        // hash collision, keep the first image indexed
+        return std::make_shared<const MappedRom>(std::move(rom));
+    }
+    auto image = std::make_shared<const MappedRom>(std::move(rom));
+    images_.emplace(image->hash(), image);
+    return image;
+}
+
+std::size_t RomLibrary::size() const {
+    const std::lock_guard lock{mutex_};
+    return images_.size();
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "chip8.h"
+#include "common.h"
+
+/// A ROM file mapped read only into memory, unmapped when destroyed.
+class MappedRom {
+  public:
+    MappedRom() = default;
+    ~MappedRom();
+    MappedRom(MappedRom &&other) noexcept;
+    MappedRom &operator=(MappedRom &&other) noexcept;
+
+    /// maps the file at @param path. Logs an error and returns an empty
+    /// MappedRom if the file can not be read, is empty or is larger than
+    /// @param max_size, the MAX_ROM_SIZE of the core it is loaded into
+    static MappedRom open(const std::filesystem::path &path,
+                          std::size_t max_size = Chip8::MAX_ROM_SIZE);
+
+    std::span<const u8> bytes() const noexcept { return {data_, size_}; }
+    bool empty() const noexcept { return size_ == 0; }
+    /// fnv1a hash of the contents
+    u64 hash() const noexcept { return hash_; }
+
+  private:
+    const u8 *data_ = nullptr;
+    std::size_t size_ = 0;
+    u64 hash_ = 0;
+#if !defined(__unix__)
+    // no mmap, the file is read into here
+    std::vector<u8> contents_;
+#endif
+
+    void release() noexcept;
+};
+
+/// Index of ROM images keyed by the hash of their contents, so every load of
+/// the same ROM shares one immutable image. Safe to use from several
+/// threads.
+class RomLibrary {
+  public:
+    /// returns the image with the contents of the file at @param path,
+    /// nullptr if it can not be read
+    std::shared_ptr<const MappedRom> load(const std::filesystem::path &path);
+
+    /// number of distinct images held
+    std::size_t size() const;
+
+  private:
+    mutable std::mutex mutex_;
+    std::unordered_map<u64, std::shared_ptr<const MappedRom>> images_;
+};
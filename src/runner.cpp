@@ -0,0 +1,256 @@
+// Headless batch runner: runs every .ch8 file in a directory for a fixed
+// budget without opening a window and prints one result line per ROM. ROMs
+// with a movie of the same name (.c8m) replay its input instead.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "spdlog/spdlog.h"
+
+#include "chip8.h"
+#include "common.h"
+#include "movie.h"
+#include "profiler.h"
+#include "rom.h"
+#include "thread_pool.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+struct Options {
+    fs::path rom_dir;
+    u64 cycles = 0;
+    u64 frames = 600;
+    // soak test, runs every rom uncapped for this long instead of a budget
+    std::chrono::seconds soak{0};
+    u32 instructions_per_frame = 10;
+    u32 threads = std::thread::hardware_concurrency();
+    Chip8::Backend backend = Chip8::Backend::block_cache;
+    // writes a profile of every rom here, needs a CHIP8_PROFILE build
+    fs::path profile_dir;
+};
+
+struct Result {
+    fs::path path;
+    u64 cycles_executed = 0;
+    u64 screen_hash = 0;
+    std::chrono::nanoseconds wall_time{0};
+    bool loaded = false;
+};
+
+void print_usage(const char *program) {
+    std::fprintf(stderr,
+                 "usage: %s <rom_dir> [--cycles N | --frames N] [--ipf N] "
+                 "[--threads N] [--soak SECONDS] [--profile DIR] "
+                 "[--interpreter | --jit]\n",
+                 program);
+}
+
+bool parse_options(int argc, char *argv[], Options &options) {
+    if (argc < 2) {
+        return false;
+    }
+    options.rom_dir = argv[1];
+
+    for (auto i = 2; i < argc; ++i) {
+        const auto arg = std::string_view{argv[i]};
+        if (arg == "--interpreter") {
+            options.backend = Chip8::Backend::interpreter;
+            continue;
+        }
+        if (arg == "--jit") {
+            options.backend = Chip8::Backend::jit;
+            continue;
+        }
+        if (arg == "--profile" && i + 1 < argc) {
+            if (!profile::COMPILED) {
+                std::fprintf(stderr, "--profile needs a build with "
+                                     "-DCHIP8_PROFILE=ON\n");
+                return false;
+            }
+            options.profile_dir = argv[++i];
+            continue;
+        }
+        if (i + 1 >= argc) {
+            return false;
+        }
+        const auto value = std::stoull(argv[++i]);
+        if (arg == "--cycles") {
+            options.cycles = value;
+        } else if (arg == "--frames") {
+            options.frames = value;
+        } else if (arg == "--ipf" && value > 0) {
+            options.instructions_per_frame = static_cast<u32>(value);
+        } else if (arg == "--threads") {
+            options.threads = static_cast<u32>(value);
+        } else if (arg == "--soak") {
+            options.soak = std::chrono::seconds{value};
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// runs @param chip8 until @param cycle_budget, for @param options.soak or
+// through the movie at @param movie_path, returns the cycles executed or
+// std::nullopt if the movie does not fit the ROM
+std::optional<u64> run_chip8(Chip8 &chip8, const MappedRom &rom,
+                             const fs::path &movie_path, u64 cycle_budget,
+                             const Options &options) {
+    if (fs::exists(movie_path)) {
+        const auto movie = read_movie_file(movie_path);
+        if (!movie || movie->rom_hash != rom.hash() ||
+            !recorded_on<Chip8>(*movie)) {
+            return std::nullopt;
+        }
+        return play_movie(chip8, *movie);
+    }
+
+    u64 cycles_executed = 0;
+    if (options.soak.count() > 0) {
+        const auto end = std::chrono::steady_clock::now() + options.soak;
+        while (std::chrono::steady_clock::now() < end) {
+            const auto executed =
+                run_frame(chip8, 0x0, options.instructions_per_frame);
+            cycles_executed += executed;
+            if (executed < options.instructions_per_frame) {
+                break;
+            }
+        }
+        return cycles_executed;
+    }
+
+    while (cycles_executed < cycle_budget) {
+        // the timers run at one tick per emulated frame
+        const auto frame = static_cast<u32>(std::min<u64>(
+            options.instructions_per_frame, cycle_budget - cycles_executed));
+        const auto executed = chip8.run(frame);
+        cycles_executed += executed;
+        if (executed < frame) {
+            // the pc ran off the end of memory
+            break;
+        }
+        chip8.tick_timers();
+    }
+    return cycles_executed;
+}
+
+void write_profile(const Profiler &profiler, const fs::path &rom,
+                   const fs::path &dir) {
+    auto base = dir / rom.filename();
+    std::ofstream folded{base.replace_extension(".folded")};
+    profiler.write_folded(folded);
+    std::ofstream report{base.replace_extension(".profile.txt")};
+    profiler.write_report(report);
+    if (!folded || !report) {
+        spdlog::error("Could not write the profile of {} to {}", rom.string(),
+                      dir.string());
+    }
+}
+
+Result run_rom(const fs::path &path, u64 cycle_budget, const Options &options,
+               RomLibrary &library) {
+    auto result = Result{.path = path};
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto rom = library.load(path);
+    if (!rom) {
+        return result;
+    }
+
+    Chip8 chip8;
+    chip8.set_backend(options.backend);
+    chip8.load_rom(rom->bytes());
+    auto profiler = Profiler::for_variant<variant::Chip8>();
+    if (!options.profile_dir.empty()) {
+        chip8.set_profiler(&profiler);
+    }
+
+    // a movie next to the ROM replaces the budget with its recorded input
+    auto movie_path = path;
+    movie_path.replace_extension(".c8m");
+    const auto executed =
+        run_chip8(chip8, *rom, movie_path, cycle_budget, options);
+    if (!executed) {
+        spdlog::error("{} was not recorded with {}", movie_path.string(),
+                      path.string());
+        return result;
+    }
+
+    result.loaded = true;
+    result.cycles_executed = *executed;
+    result.screen_hash = chip8.screen_hash();
+    result.wall_time = std::chrono::steady_clock::now() - start;
+    if (!options.profile_dir.empty()) {
+        write_profile(profiler, path, options.profile_dir);
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto options = Options{};
+    if (!parse_options(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    spdlog::set_level(spdlog::level::info);
+
+    std::vector<fs::path> roms;
+    for (const auto &entry : fs::directory_iterator{options.rom_dir}) {
+        if (entry.is_regular_file() && entry.path().extension() == ".ch8") {
+            roms.push_back(entry.path());
+        }
+    }
+    std::ranges::sort(roms);
+
+    const auto cycle_budget =
+        options.cycles > 0 ? options.cycles
+                           : options.frames * options.instructions_per_frame;
+
+    std::vector<Result> results(roms.size());
+    // copies of the same ROM share one image
+    RomLibrary library;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool{options.threads};
+        for (auto i = 0u; i < roms.size(); ++i) {
+            pool.submit([&results, &roms, &options, &library, i,
+                         cycle_budget] {
+                results[i] = run_rom(roms[i], cycle_budget, options, library);
+            });
+        }
+        pool.wait();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("rom\tcycles\tscreen_hash\twall_us\n");
+    for (const auto &result : results) {
+        if (!result.loaded) {
+            std::printf("%s\tFAILED\n", result.path.c_str());
+            continue;
+        }
+        std::printf(
+            "%s\t%llu\t%016llx\t%lld\n", result.path.c_str(),
+            static_cast<unsigned long long>(result.cycles_executed),
+            static_cast<unsigned long long>(result.screen_hash),
+            static_cast<long long>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    result.wall_time)
+                    .count()));
+    }
+
+    spdlog::info(
+        "Ran {} roms ({} distinct) in {} ms", roms.size(), library.size(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count());
+}
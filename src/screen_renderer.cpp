@@ -0,0 +1,89 @@
+#include "screen_renderer.h"
+
+#include "spdlog/spdlog.h"
+
+template <typename Core> void ScreenRenderer<Core>::destroy() {
+    if (texture_) {
+        SDL_DestroyTexture(texture_);
+        texture_ = nullptr;
+    }
+}
+
+template <typename Core>
+u32 ScreenRenderer<Core>::init(SDL_Renderer *renderer) {
+    renderer_ = renderer;
+    // nearest neighbour scaling keeps the pixels sharp
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+    texture_ = SDL_CreateTexture(renderer_, SDL_PIXELFORMAT_ARGB8888,
+                                 SDL_TEXTUREACCESS_STREAMING,
+                                 Core::SCREEN_WIDTH, Core::SCREEN_HEIGHT);
+    if (!texture_) {
+        spdlog::error("Screen texture could not be created!\nError: {}",
+                      SDL_GetError());
+        return 10;
+    }
+
+    invalidate();
+    return 0;
+}
+
+template <typename Core>
+void ScreenRenderer<Core>::render(const Screen &screen) {
+    // init failed, there is nothing to draw through
+    if (!texture_) {
+        return;
+    }
+    if (uploaded_valid_ && screen == uploaded_) {
+        ++skipped_uploads_;
+    } else {
+        upload(screen);
+    }
+
+    SDL_RenderCopy(renderer_, texture_, nullptr, nullptr);
+    SDL_RenderPresent(renderer_);
+}
+
+// expands every row word into ARGB pixels in one pass over the locked texture
+template <typename Core>
+void ScreenRenderer<Core>::upload(const Screen &screen) {
+    void *pixels = nullptr;
+    int pitch = 0;
+    if (SDL_LockTexture(texture_, nullptr, &pixels, &pitch) < 0) {
+        spdlog::error("Screen texture could not be locked!\nError: {}",
+                      SDL_GetError());
+        return;
+    }
+
+    constexpr auto LAST_COLUMN = Core::SCREEN_WIDTH - 1;
+    const auto flip = palette_[0] ^ palette_[1];
+    for (auto row = 0u; row < Core::SCREEN_HEIGHT; ++row) {
+        auto *dst = reinterpret_cast<u32 *>(static_cast<u8 *>(pixels) +
+                                            row * static_cast<u32>(pitch));
+        for (auto col = 0u; col < Core::SCREEN_WIDTH; ++col) {
+            if constexpr (Core::PLANES == 1) {
+                const u32 bit = (screen[row] >> (LAST_COLUMN - col)) & 0x1u;
+                dst[col] = palette_[0] ^ (flip & (0u - bit));
+            } else {
+                auto index = 0u;
+                for (auto plane = 0u; plane < Core::PLANES; ++plane) {
+                    const auto word = screen[plane * Core::SCREEN_HEIGHT + row];
+                    index |= static_cast<u32>((word >> (LAST_COLUMN - col)) &
+                                              0x1u)
+                             << plane;
+                }
+                dst[col] = palette_[index];
+            }
+        }
+    }
+
+    SDL_UnlockTexture(texture_);
+    uploaded_ = screen;
+    uploaded_valid_ = true;
+}
+
+template class ScreenRenderer<Chip8>;
+template class ScreenRenderer<Chip8Core<variant::Chip8, quirks::Cosmac>>;
+template class ScreenRenderer<Chip8Core<variant::Chip8, quirks::SuperChip>>;
+template class ScreenRenderer<Chip8Core<variant::Chip8, quirks::XoChip>>;
+template class ScreenRenderer<SuperChip>;
+template class ScreenRenderer<XoChip>;
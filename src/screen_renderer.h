@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+
+#include "SDL.h"
+
+#include "chip8.h"
+#include "common.h"
+
+struct ScreenColor {
+    u8 red;
+    u8 green;
+    u8 blue;
+};
+
+/// Draws the screen of a @tparam Core through a SCREEN_WIDTH x SCREEN_HEIGHT
+/// streaming texture which SDL scales to the render target.
+template <typename Core> class ScreenRenderer {
+  public:
+    using Color = ScreenColor;
+    using Screen = typename Core::Screen;
+    /// the color of each pixel value, bit p of which is the pixel in
+    /// bitplane p. The first is the background
+    using Palette = std::array<Color, 1u << Core::PLANES>;
+
+    explicit ScreenRenderer(const Palette &palette) {
+        for (auto index = 0u; index < palette.size(); ++index) {
+            palette_[index] = to_argb(palette[index]);
+        }
+    }
+    ~ScreenRenderer() { destroy(); }
+
+    ScreenRenderer(const ScreenRenderer &) = delete;
+    ScreenRenderer &operator=(const ScreenRenderer &) = delete;
+
+    /// creates the texture on @param renderer, returns 0 on success
+    u32 init(SDL_Renderer *renderer);
+
+    /// destroys the texture, must be called before its renderer is destroyed
+    void destroy();
+
+    /// uploads @param screen if it changed since the last upload, then
+    /// copies the texture over the whole render target
+    void render(const Screen &screen);
+
+    /// forces the next render to upload, needed when the render targets were
+    /// reset. A device reset loses the texture itself, which needs destroy()
+    /// and init() again
+    void invalidate() noexcept { uploaded_valid_ = false; }
+
+    /// number of renders which skipped the upload
+    u64 skipped_uploads() const noexcept { return skipped_uploads_; }
+
+  private:
+    SDL_Renderer *renderer_ = nullptr;
+    SDL_Texture *texture_ = nullptr;
+
+    // ARGB8888 colors
+    std::array<u32, 1u << Core::PLANES> palette_;
+
+    // the screen currently in the texture
+    Screen uploaded_ = {0x0};
+    bool uploaded_valid_ = false;
+    u64 skipped_uploads_ = 0;
+
+    static constexpr u32 to_argb(Color color) noexcept {
+        return 0xFF000000u | (color.red << 16) | (color.green << 8) |
+               color.blue;
+    }
+
+    void upload(const Screen &screen);
+};
+
+extern template class ScreenRenderer<Chip8>;
+extern template class ScreenRenderer<Chip8Core<variant::Chip8, quirks::Cosmac>>;
+extern template class ScreenRenderer<
+    Chip8Core<variant::Chip8, quirks::SuperChip>>;
+extern template class ScreenRenderer<Chip8Core<variant::Chip8, quirks::XoChip>>;
+extern template class ScreenRenderer<SuperChip>;
+extern template class ScreenRenderer<XoChip>;
@@ -0,0 +1,47 @@
+#include "sdl_audio_sink.h"
+
+#include "spdlog/spdlog.h"
+
+u32 SdlAudioSink::start(AudioOutput &output) {
+    stop();
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        spdlog::error("Audio could not be initialized!\nError: {}",
+                      SDL_GetError());
+        return 10;
+    }
+
+    const auto &config = output.config();
+    auto wanted = SDL_AudioSpec{};
+    wanted.freq = static_cast<int>(config.sample_rate);
+    wanted.format = AUDIO_F32SYS;
+    wanted.channels = 1;
+    wanted.samples = static_cast<Uint16>(config.buffer_samples);
+    wanted.callback = callback;
+    wanted.userdata = &output;
+    // SDL converts if the device wants another format, so the callback
+    // always sees the config of output
+    device_ = SDL_OpenAudioDevice(nullptr, 0, &wanted, nullptr, 0);
+    if (device_ == 0) {
+        spdlog::error("Audio device could not be opened!\nError: {}",
+                      SDL_GetError());
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return 20;
+    }
+
+    SDL_PauseAudioDevice(device_, 0);
+    return 0;
+}
+
+void SdlAudioSink::stop() {
+    if (device_ != 0) {
+        SDL_CloseAudioDevice(device_);
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        device_ = 0;
+    }
+}
+
+void SdlAudioSink::callback(void *userdata, Uint8 *stream, int length) {
+    auto &output = *static_cast<AudioOutput *>(userdata);
+    output.fill({reinterpret_cast<float *>(stream),
+                 static_cast<std::size_t>(length) / sizeof(float)});
+}
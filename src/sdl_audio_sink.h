@@ -0,0 +1,26 @@
+#pragma once
+
+#include "SDL.h"
+
+#include "audio.h"
+#include "common.h"
+
+/// Plays an AudioOutput through the default SDL audio device, filling
+/// buffers on SDL's audio callback thread.
+class SdlAudioSink final : public AudioSink {
+  public:
+    SdlAudioSink() = default;
+    ~SdlAudioSink() override { stop(); }
+
+    SdlAudioSink(const SdlAudioSink &) = delete;
+    SdlAudioSink &operator=(const SdlAudioSink &) = delete;
+
+    /// opens the device and starts playback, returns 0 on success
+    u32 start(AudioOutput &output) override;
+    void stop() override;
+
+  private:
+    SDL_AudioDeviceID device_ = 0;
+
+    static void callback(void *userdata, Uint8 *stream, int length);
+};
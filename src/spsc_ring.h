@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <vector>
+
+#include "common.h"
+
+/// Bounded lock-free queue between exactly one producer thread and one
+/// consumer thread. Neither side blocks, push() fails when the ring is full.
+template <typename T> class SpscRing {
+  public:
+    /// @param capacity is rounded up to a power of two
+    explicit SpscRing(u32 capacity)
+        : slots_(std::bit_ceil(std::max(capacity, 1u))),
+          mask_{slots_.size() - 1} {}
+
+    std::size_t capacity() const noexcept { return slots_.size(); }
+
+    /// appends @param value, returns false if the ring is full. Only called
+    /// by the producer
+    bool push(const T &value) noexcept {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == slots_.size()) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == slots_.size()) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// moves the oldest value into @param value, returns false if the ring
+    /// is empty. Only called by the consumer
+    bool pop(T &value) noexcept {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) {
+                return false;
+            }
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+  private:
+    std::vector<T> slots_;
+    std::size_t mask_;
+    // written by the producer, with its last look at head_
+    alignas(64) std::atomic<std::size_t> tail_ = 0;
+    std::size_t head_cache_ = 0;
+    // written by the consumer, with its last look at tail_
+    alignas(64) std::atomic<std::size_t> head_ = 0;
+    std::size_t tail_cache_ = 0;
+};
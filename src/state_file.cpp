@@ -0,0 +1,106 @@
+#include "state_file.h"
+
+#include <fstream>
+#include <istream>
+#include <ostream>
+
+#include "spdlog/spdlog.h"
+
+#include "binary_io.h"
+
+namespace {
+
+void write_bool(std::ostream &out, bool value) {
+    write_field(out, static_cast<u8>(value));
+}
+
+// returns false unless the byte read is 0 or 1
+bool read_bool(std::istream &in, bool &value) {
+    auto byte = u8{0};
+    read_field(in, byte);
+    value = byte == 1;
+    return byte <= 1;
+}
+
+void write_state(std::ostream &out, const Chip8::State &state) {
+    write_field(out, state.screen);
+    write_field(out, state.stack);
+    write_field(out, state.V);
+    write_field(out, state.pc);
+    write_field(out, state.I);
+    write_field(out, state.sp);
+    write_field(out, state.sound);
+    write_field(out, state.delay);
+    write_field(out, state.keys);
+    write_bool(out, state.bad_opcode);
+    write_bool(out, state.stack_fault);
+    write_field(out, state.memory);
+}
+
+// returns false if a field holds a value the machine can not be in
+bool read_state(std::istream &in, Chip8::State &state) {
+    read_field(in, state.screen);
+    read_field(in, state.stack);
+    read_field(in, state.V);
+    read_field(in, state.pc);
+    read_field(in, state.I);
+    read_field(in, state.sp);
+    read_field(in, state.sound);
+    read_field(in, state.delay);
+    read_field(in, state.keys);
+    auto valid = read_bool(in, state.bad_opcode);
+    valid = read_bool(in, state.stack_fault) && valid;
+    read_field(in, state.memory);
+    return valid && state.sp <= Chip8::STACK_SIZE;
+}
+
+} // namespace
+
+bool write_state_file(const std::filesystem::path &path,
+                      const Chip8::State &state) {
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    const auto header = StateFileHeader{};
+    write_field(file, header.magic);
+    write_field(file, header.version);
+    write_state(file, state);
+
+    if (!file) {
+        spdlog::error("State File: could not write {}", path.string());
+        return false;
+    }
+    return true;
+}
+
+std::optional<Chip8::State> read_state_file(const std::filesystem::path &path) {
+    std::ifstream file{path, std::ios::binary};
+    auto header = StateFileHeader{};
+    read_field(file, header.magic);
+    read_field(file, header.version);
+    if (!file) {
+        spdlog::error("State File: could not read {}", path.string());
+        return std::nullopt;
+    }
+
+    const auto expected = StateFileHeader{};
+    if (header.magic != expected.magic) {
+        spdlog::error("State File: {} is not a state file", path.string());
+        return std::nullopt;
+    }
+    if (header.version != expected.version) {
+        spdlog::error("State File: {} has version {}, expected version {}",
+                      path.string(), header.version, expected.version);
+        return std::nullopt;
+    }
+
+    auto state = Chip8::State{};
+    const auto valid = read_state(file, state);
+    if (!file) {
+        spdlog::error("State File: {} is truncated", path.string());
+        return std::nullopt;
+    }
+    if (!valid) {
+        spdlog::error("State File: {} holds an invalid state", path.string());
+        return std::nullopt;
+    }
+    return state;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <optional>
+
+#include "chip8.h"
+#include "common.h"
+
+// On disk a saved state is the fields of a StateFileHeader followed by the
+// fields of Chip8::State, one after the other in declaration order, each
+// bool as a u8, in host byte order. Any change to the fields of
+// Chip8::State must bump STATE_FILE_VERSION.
+
+inline constexpr u32 STATE_FILE_VERSION = 4;
+
+struct StateFileHeader {
+    std::array<char, 4> magic = {'C', '8', 'S', 'T'};
+    u32 version = STATE_FILE_VERSION;
+};
+
+/// writes @param state to @param path, returns false on failure
+bool write_state_file(const std::filesystem::path &path,
+                      const Chip8::State &state);
+
+/// reads a state written by write_state_file, returns std::nullopt if the
+/// file can not be read, was written by another version or holds a state
+/// the machine can not be in
+std::optional<Chip8::State> read_state_file(const std::filesystem::path &path);
@@ -0,0 +1,113 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+// set for the threads of a pool to their index in it
+thread_local std::optional<u32> current_worker;
+
+} // namespace
+
+ThreadPool::ThreadPool(u32 threads) : size_{std::max(threads, 1u)} {
+    for (auto i = 0u; i < size_; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    workers_.reserve(size_);
+    for (auto i = 0u; i < size_; ++i) {
+        workers_.emplace_back([this, i] { work(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    stopping_ = true;
+    for (auto i = 0u; i < size(); ++i) {
+        wake(i);
+    }
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    pending_.fetch_add(1);
+    // counted before it is pushed, a worker which sees the count before the
+    // task retries until it appears
+    queued_.fetch_add(1);
+    const auto index = next_queue_.fetch_add(1) % size();
+    {
+        std::scoped_lock lock{queues_[index]->mutex};
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    wake(index);
+}
+
+void ThreadPool::wait() {
+    for (auto pending = pending_.load(); pending != 0;
+         pending = pending_.load()) {
+        pending_.wait(pending);
+    }
+}
+
+std::optional<u32> ThreadPool::worker_index() noexcept {
+    return current_worker;
+}
+
+void ThreadPool::wake(u32 index) noexcept {
+    queues_[index]->signal.fetch_add(1);
+    queues_[index]->signal.notify_one();
+}
+
+/// pops from the back of our own queue, otherwise steals from the front of
+/// another worker's queue
+std::optional<ThreadPool::Task> ThreadPool::take(u32 index) {
+    {
+        auto &own = *queues_[index];
+        std::scoped_lock lock{own.mutex};
+        if (!own.tasks.empty()) {
+            auto task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return task;
+        }
+    }
+
+    for (auto offset = 1u; offset < size(); ++offset) {
+        auto &victim = *queues_[(index + offset) % size()];
+        std::scoped_lock lock{victim.mutex};
+        if (!victim.tasks.empty()) {
+            auto task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return task;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void ThreadPool::work(u32 index) {
+    current_worker = index;
+    auto &signal = queues_[index]->signal;
+    while (true) {
+        // read before looking for work, a task submitted after the look
+        // changes it and the wait below returns at once
+        const auto seen = signal.load();
+        if (auto task = take(index)) {
+            // more work is queued than we took, pass the wake up along so a
+            // sleeping worker comes to steal it
+            if (queued_.fetch_sub(1) > 1 && size() > 1) {
+                wake((index + 1) % size());
+            }
+            (*task)();
+            if (pending_.fetch_sub(1) == 1) {
+                pending_.notify_all();
+            }
+        } else if (queued_.load() > 0) {
+            // counted but not pushed yet
+            std::this_thread::yield();
+        } else if (stopping_) {
+            return;
+        } else {
+            signal.wait(seen);
+        }
+    }
+}
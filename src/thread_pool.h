@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "common.h"
+
+/// Fixed size work-stealing thread pool.
+/// Each worker owns a deque, it pops its own work from the back and steals
+/// from the front of the other workers' deques when it runs dry. Outstanding
+/// work is tracked with atomic counters, so no lock is shared by every
+/// worker, and an idle worker sleeps on its own signal.
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(u32 threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    u32 size() const noexcept { return size_; }
+
+    /// queues @param task, tasks are spread round robin over the workers
+    void submit(Task task);
+    /// blocks until every submitted task has finished
+    void wait();
+
+    /// the index of the worker running the calling thread, std::nullopt
+    /// outside of any pool
+    static std::optional<u32> worker_index() noexcept;
+
+  private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        // bumped to wake the worker sleeping on it
+        std::atomic<u32> signal = 0;
+    };
+
+    // set before any worker starts, workers_ still grows while they run
+    const u32 size_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    // tasks submitted but not yet finished
+    std::atomic<u32> pending_ = 0;
+    // tasks submitted but not yet taken by a worker
+    std::atomic<u32> queued_ = 0;
+    std::atomic<u32> next_queue_ = 0;
+    std::atomic<bool> stopping_ = false;
+
+    void work(u32 index);
+    std::optional<Task> take(u32 index);
+    void wake(u32 index) noexcept;
+};
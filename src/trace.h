@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+
+#include "spdlog/spdlog.h"
+
+#include "common.h"
+
+// Tracing for the emulator hot paths.
+//
+// Which categories exist in the binary is decided at compile time through
+// CHIP8_TRACE_CATEGORIES, a mask of trace::Category bits. Release builds
+// (NDEBUG) default to no categories so every CHIP8_TRACE, including its
+// argument setup, is compiled out. Categories that are compiled in can be
+// switched on and off at runtime with trace::enable, and still go through
+// spdlog so they are only printed at the debug level.
+
+namespace trace {
+
+enum class Category : u32 {
+    fetch = 1u << 0,
+    decode = 1u << 1,
+    registers = 1u << 2,
+    draw = 1u << 3,
+    stack = 1u << 4,
+};
+
+inline constexpr u32 ALL_CATEGORIES = 0x1Fu;
+
+#ifndef CHIP8_TRACE_CATEGORIES
+#ifdef NDEBUG
+#define CHIP8_TRACE_CATEGORIES 0x0u
+#else
+#define CHIP8_TRACE_CATEGORIES ::trace::ALL_CATEGORIES
+#endif
+#endif
+
+inline constexpr u32 COMPILED_CATEGORIES = CHIP8_TRACE_CATEGORIES;
+
+/// true if tracing for @param category is part of this build
+constexpr bool compiled_in(Category category) noexcept {
+    return (COMPILED_CATEGORIES & static_cast<u32>(category)) != 0;
+}
+
+// categories switched on at runtime, only consulted for compiled in ones
+inline std::atomic<u32> enabled_categories{ALL_CATEGORIES};
+
+inline bool enabled(Category category) noexcept {
+    return (enabled_categories.load(std::memory_order_relaxed) &
+            static_cast<u32>(category)) != 0;
+}
+
+inline void enable(Category category, bool on = true) noexcept {
+    if (on) {
+        enabled_categories.fetch_or(static_cast<u32>(category),
+                                    std::memory_order_relaxed);
+    } else {
+        enabled_categories.fetch_and(~static_cast<u32>(category),
+                                     std::memory_order_relaxed);
+    }
+}
+
+} // namespace trace
+
+// the arguments are only evaluated when the category is compiled in and
+// enabled
+#define CHIP8_TRACE(category, ...)                                             \
+    do {                                                                       \
+        if constexpr (::trace::compiled_in(::trace::Category::category)) {    \
+            if (::trace::enabled(::trace::Category::category)) {               \
+                spdlog::debug(__VA_ARGS__);                                    \
+            }                                                                  \
+        }                                                                      \
+    } while (false)
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "common.h"
+
+/// Lock-free handoff of the latest value from one writer thread to one
+/// reader thread. The writer fills its back buffer and publishes it, the
+/// reader picks up the most recently published one. Neither side ever
+/// waits, a value published twice before the reader looks is overwritten.
+template <typename T> class TripleBuffer {
+  public:
+    /// the buffer the writer fills, only touched by the writer thread
+    T &write_buffer() noexcept { return buffers_[back_]; }
+
+    /// hands the write buffer to the reader and takes the spare one back
+    void publish() noexcept {
+        const auto previous =
+            middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+        if (previous & FRESH) {
+            ++overwritten_;
+        }
+        back_ = previous & INDEX;
+        ++published_;
+    }
+
+    /// swaps in the latest published value if there is one, returns whether
+    /// read_buffer() changed. Only called by the reader thread
+    bool update() noexcept {
+        if (!(middle_.load(std::memory_order_relaxed) & FRESH)) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /// the value last picked up by update(), only touched by the reader
+    const T &read_buffer() const noexcept { return buffers_[front_]; }
+
+    /// values published, read by the writer thread
+    u64 published() const noexcept { return published_; }
+    /// values overwritten before the reader picked them up, read by the
+    /// writer thread
+    u64 overwritten() const noexcept { return overwritten_; }
+
+  private:
+    static constexpr u32 INDEX = 0x3;
+    // set in middle_ while it holds a value the reader has not picked up
+    static constexpr u32 FRESH = 0x4;
+
+    std::array<T, 3> buffers_{};
+    // owned by the writer
+    alignas(64) u32 back_ = 0;
+    u64 published_ = 0;
+    u64 overwritten_ = 0;
+    // handed between the two threads
+    alignas(64) std::atomic<u32> middle_{1};
+    // owned by the reader
+    alignas(64) u32 front_ = 2;
+};
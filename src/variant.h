@@ -0,0 +1,136 @@
+#pragma once
+
+#include <string_view>
+
+#include "common.h"
+#include "decode.h"
+
+// The machines a Chip8Core emulates. Each policy fixes the screen, the size
+// of memory and the decoder at compile time, so the CHIP-8 core carries
+// nothing of the larger machines.
+
+// The behaviors interpreters disagree on. A Chip8Core is compiled for one
+// profile, so no handler tests a quirk at runtime.
+
+namespace quirks {
+
+/// what this emulator has always done, the default for CHIP-8
+struct Modern {
+    static constexpr std::string_view NAME = "modern";
+    // 8XY6 and 8XYE shift VY into VX instead of shifting VX in place
+    static constexpr bool SHIFT_VY = false;
+    // FX55 and FX65 leave I past the last register instead of unchanged
+    static constexpr bool LOAD_STORE_INCREMENT_I = false;
+    // BNNN jumps to NNN + VX, X being the top nibble of NNN, instead of
+    // NNN + V0
+    static constexpr bool JUMP_VX = false;
+    // sprites wrap around the edges of the screen instead of being clipped
+    static constexpr bool WRAP_SPRITES = false;
+};
+
+/// the original interpreter of the COSMAC VIP
+struct Cosmac {
+    static constexpr std::string_view NAME = "cosmac";
+    static constexpr bool SHIFT_VY = true;
+    static constexpr bool LOAD_STORE_INCREMENT_I = true;
+    static constexpr bool JUMP_VX = false;
+    static constexpr bool WRAP_SPRITES = false;
+};
+
+/// SUPER-CHIP 1.1 on the HP 48
+struct SuperChip {
+    static constexpr std::string_view NAME = "schip";
+    static constexpr bool SHIFT_VY = false;
+    static constexpr bool LOAD_STORE_INCREMENT_I = false;
+    static constexpr bool JUMP_VX = true;
+    static constexpr bool WRAP_SPRITES = false;
+};
+
+/// XO-CHIP as Octo runs it
+struct XoChip {
+    static constexpr std::string_view NAME = "xochip";
+    static constexpr bool SHIFT_VY = true;
+    static constexpr bool LOAD_STORE_INCREMENT_I = true;
+    static constexpr bool JUMP_VX = false;
+    static constexpr bool WRAP_SPRITES = true;
+};
+
+} // namespace quirks
+
+namespace variant {
+
+/// the original CHIP-8, a 64x32 screen and 4 KB of memory
+struct Chip8 {
+    static constexpr std::string_view NAME = "chip8";
+    static constexpr u32 SCREEN_WIDTH = 64;
+    static constexpr u32 SCREEN_HEIGHT = 32;
+    // bitplanes drawn over each other, each selects one bit of the color
+    static constexpr u32 PLANES = 1;
+    static constexpr u32 MEMORY_SIZE = 4096;
+    // 00FE and 00FF switch between drawing doubled pixels and the full
+    // resolution
+    static constexpr bool HIRES = false;
+    // F000 NNNN loads I from the word after it, skips step over both words
+    static constexpr bool LONG_LOAD = false;
+
+    // one screen row, column 0 in the most significant bit
+    using Row = u64;
+    using Quirks = quirks::Modern;
+
+    static constexpr Op decode(u16 opcode) noexcept {
+        return ::decode(opcode);
+    }
+};
+
+/// SUPER-CHIP 1.1, a 128x64 screen drawn at 64x32 until switched to hires
+struct SuperChip {
+    static constexpr std::string_view NAME = "schip";
+    static constexpr u32 SCREEN_WIDTH = 128;
+    static constexpr u32 SCREEN_HEIGHT = 64;
+    static constexpr u32 PLANES = 1;
+    static constexpr u32 MEMORY_SIZE = 4096;
+    static constexpr bool HIRES = true;
+    static constexpr bool LONG_LOAD = false;
+
+    using Row = u128;
+    using Quirks = quirks::SuperChip;
+
+    static constexpr Op decode(u16 opcode) noexcept {
+        return decode_superchip(opcode);
+    }
+};
+
+/// XO-CHIP, SUPER-CHIP with two bitplanes and 64 KB of memory
+struct XoChip {
+    static constexpr std::string_view NAME = "xochip";
+    static constexpr u32 SCREEN_WIDTH = 128;
+    static constexpr u32 SCREEN_HEIGHT = 64;
+    static constexpr u32 PLANES = 2;
+    static constexpr u32 MEMORY_SIZE = 65536;
+    static constexpr bool HIRES = true;
+    static constexpr bool LONG_LOAD = true;
+
+    using Row = u128;
+    using Quirks = quirks::XoChip;
+
+    static constexpr Op decode(u16 opcode) noexcept {
+        return decode_xochip(opcode);
+    }
+};
+
+} // namespace variant
+
+template <u32 Size> class FlatMemory;
+template <u32 Size> class BasicPagedMemory;
+
+template <typename Variant, typename Quirks = typename Variant::Quirks,
+          template <u32> class MemoryModel = FlatMemory>
+class Chip8Core;
+
+using Chip8 = Chip8Core<variant::Chip8>;
+using SuperChip = Chip8Core<variant::SuperChip>;
+using XoChip = Chip8Core<variant::XoChip>;
+/// CHIP-8 with memory pages shared between instances until written, for
+/// running many instances of one ROM
+using SharedChip8 =
+    Chip8Core<variant::Chip8, variant::Chip8::Quirks, BasicPagedMemory>;
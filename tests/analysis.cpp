@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <boost/ut.hpp>
+#include <sstream>
+#include <vector>
+
+#include "../src/analysis.h"
+#include "../src/common.h"
+
+namespace {
+
+using analysis::Issue;
+
+bool has_issue(const analysis::Analysis &result, Issue::Kind kind,
+               u16 address) {
+    return std::ranges::find(result.issues, Issue{kind, address}) !=
+           result.issues.end();
+}
+
+} // namespace
+
+boost::ut::suite analysis_suite = [] {
+    using namespace boost::ut;
+
+    "check code, data, blocks and the call graph"_test = [] {
+        const std::vector<u8> rom{
+            0x60, 0x00, // 200: V0 = 0
+            0xA2, 0x10, // 202: I = 210
+            0xD0, 0x02, // 204: draw 2 rows
+            0x22, 0x0C, // 206: call 20C
+            0x12, 0x06, // 208: jump 206
+            0x00, 0x00, // 20A
+            0x70, 0x01, // 20C: V0 += 1
+            0x00, 0xEE, // 20E: return
+            0xF0, 0x90, // 210: sprite
+        };
+        const auto result = analysis::analyze(rom);
+
+        expect(eq(result.blocks.size(), 4u));
+        expect(eq(result.blocks[0].start, 0x200));
+        expect(eq(result.blocks[0].end, 0x206));
+        expect(result.blocks[1].successors == std::vector<u16>{0x208});
+        expect(result.blocks[2].successors == std::vector<u16>{0x206});
+        expect(eq(result.routines.size(), 2u));
+        expect(result.routines[0].calls == std::vector<u16>{0x20C});
+        expect(eq(result.routines[1].entry, 0x20C));
+        expect(eq(result.routines[1].depth, 1u));
+        expect(eq(result.max_depth(), 1u));
+
+        expect(result.bytes[0x200] == analysis::Byte::code);
+        expect(result.bytes[0x20A] == analysis::Byte::unknown);
+        expect(result.bytes[0x210] == analysis::Byte::data);
+        expect(result.bytes[0x211] == analysis::Byte::data);
+        expect(result.issues.empty());
+        expect(!result.rejected());
+
+        std::ostringstream listing;
+        analysis::write_listing(result, listing);
+        expect(listing.str().find("20C  7001  ADD V0, 0x01") !=
+               std::string::npos);
+        expect(listing.str().find("210  F0    ####....") != std::string::npos);
+    };
+
+    "check jump tables are followed"_test = [] {
+        const std::vector<u8> rom{
+            0xC0, 0x02, // 200: V0 = random & 2
+            0xB2, 0x04, // 202: jump 204 + V0
+            0x12, 0x08, // 204: jump 208
+            0x12, 0x0A, // 206: jump 20A
+            0x12, 0x08, // 208: jump to self
+            0x12, 0x0A, // 20A: jump to self
+        };
+        const auto result = analysis::analyze(rom);
+        expect(eq(result.jump_tables.size(), 1u));
+        expect(result.jump_tables[0].targets ==
+               std::vector<u16>{0x204, 0x206, 0x208, 0x20A});
+        expect(result.bytes[0x20A] == analysis::Byte::code);
+
+        // with V0 known only one entry is taken
+        const std::vector<u8> known{0x60, 0x02, 0xB2, 0x04, 0x12, 0x04,
+                                    0x12, 0x06};
+        expect(analysis::analyze(known).jump_tables[0].targets ==
+               std::vector<u16>{0x206});
+    };
+
+    "check stack errors are found"_test = [] {
+        // returning from the entry point
+        const auto underflow = analysis::analyze(std::vector<u8>{0x00, 0xEE});
+        expect(has_issue(underflow, Issue::Kind::stack_underflow, 0x200));
+        expect(underflow.rejected());
+
+        // a routine calling itself
+        const auto recursion = analysis::analyze(
+            std::vector<u8>{0x22, 0x04, 0x12, 0x02, 0x22, 0x04, 0x00, 0xEE});
+        expect(has_issue(recursion, Issue::Kind::recursion, 0x204));
+        expect(eq(recursion.max_depth(), analysis::UNBOUNDED));
+        expect(!recursion.rejected());
+
+        // a chain of 17 routines, each calling the next
+        std::vector<u8> chain{0x22, 0x04, 0x12, 0x02};
+        for (auto i = 0u; i < 17; ++i) {
+            const auto next = 0x208 + 4 * i;
+            chain.insert(chain.end(), {static_cast<u8>(0x20 | next >> 8),
+                                       static_cast<u8>(next), 0x00, 0xEE});
+        }
+        const auto overflow = analysis::analyze(chain);
+        expect(eq(overflow.max_depth(), 17u));
+        expect(has_issue(overflow, Issue::Kind::stack_overflow, 0x244));
+        expect(overflow.rejected());
+    };
+
+    "check writes into code and unreachable code are found"_test = [] {
+        const std::vector<u8> rom{
+            0xA2, 0x00, // 200: I = 200
+            0xF0, 0x55, // 202: store V0 over 200
+            0x12, 0x04, // 204: jump to self
+            0x60, 0x01, // 206: never reached
+            0x61, 0x02, // 208
+            0x12, 0x06, // 20A: jump 206
+        };
+        const auto result = analysis::analyze(rom);
+        expect(has_issue(result, Issue::Kind::write_into_code, 0x202));
+        expect(has_issue(result, Issue::Kind::unreachable_code, 0x206));
+        expect(result.rejected());
+    };
+};
+
+int main() {}
@@ -0,0 +1,126 @@
+#include <boost/ut.hpp>
+#include <vector>
+
+#include "../src/aot.h"
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/recompiler.h"
+
+// roms/aot_test.ch8, translated by chip8_recompile at build time
+extern const AotProgram aot_test;
+
+namespace {
+
+bool same_state(const Chip8 &a, const Chip8 &b) {
+    return a.save_state() == b.save_state();
+}
+
+// counts in V0 forever, as one block which counts its runs
+const std::vector<u8> COUNT_ROM = {
+    0x70, 0x01, // 200: V0 += 1
+    0x12, 0x00, // 202: jump 200
+};
+u32 count_runs = 0;
+
+u32 count_block(Chip8::Machine &m, Aot &) noexcept {
+    ++count_runs;
+    m.V[0x0] = static_cast<u8>(m.V[0x0] + 1);
+    m.pc = 0x200;
+    return 2;
+}
+
+const AotBlock COUNT_BLOCKS[] = {{0x200, 0x204, 2, &count_block}};
+const AotProgram COUNT_PROGRAM = {"count", COUNT_ROM, COUNT_BLOCKS};
+
+constexpr Chip8::Backend BACKENDS[] = {Chip8::Backend::interpreter,
+                                       Chip8::Backend::block_cache,
+                                       Chip8::Backend::jit};
+
+} // namespace
+
+boost::ut::suite aot = [] {
+    using namespace boost::ut;
+
+    "check blocks are split at every target"_test = [] {
+        const std::vector<u8> rom{
+            0x60, 0x00, // 200: V0 = 0
+            0x70, 0x01, // 202: V0 += 1
+            0x30, 0x05, // 204: skip if V0 == 5
+            0x12, 0x02, // 206: jump 202
+            0xB3, 0x00, // 208: jump 300 + V0
+            0x61, 0x01, // 20A: unreachable
+        };
+        const auto blocks = recompiler::find_blocks(rom);
+        expect(blocks == std::vector<recompiler::Block>{{0x200, 0x202, 1},
+                                                        {0x202, 0x206, 2},
+                                                        {0x206, 0x208, 1},
+                                                        {0x208, 0x20A, 1}});
+    };
+
+    "check translated blocks match the interpreter"_test = [] {
+        for (const auto backend : BACKENDS) {
+            Chip8 interpreter;
+            interpreter.load_rom(aot_test.rom);
+            Chip8 translated;
+            translated.set_backend(backend);
+            translated.set_program(&aot_test);
+            translated.load_rom(aot_test.rom);
+
+            // uneven slices so budgets end in the middle of blocks, with
+            // keys and timers changing between them
+            for (auto round = 0u; round < 200; ++round) {
+                const auto slice = 1u + round * 7 % 23;
+                const auto keys = static_cast<u16>(
+                    round % 3 == 0 ? 0x0 : 1u << (round % 16));
+                interpreter.set_keys(keys);
+                translated.set_keys(keys);
+                expect(eq(interpreter.run(slice), slice));
+                expect(eq(translated.run(slice), slice));
+                interpreter.tick_timers();
+                translated.tick_timers();
+                expect(same_state(interpreter, translated));
+            }
+        }
+    };
+
+    "check programs run whatever the backend"_test = [] {
+        for (const auto backend : BACKENDS) {
+            count_runs = 0;
+            Chip8 translated;
+            translated.set_backend(backend);
+            translated.set_program(&COUNT_PROGRAM);
+            translated.load_rom(COUNT_ROM);
+            expect(eq(translated.run(100), 100u));
+            expect(eq(count_runs, 50u));
+            expect(eq(translated.V(0x0), 50));
+        }
+    };
+
+    "check blocks written over are interpreted"_test = [] {
+        Chip8 translated;
+        translated.set_program(&aot_test);
+        translated.load_rom(aot_test.rom);
+        // the loop stores V0 over the immediate of the instruction at 23C
+        translated.run(1000);
+        expect(translated.memory()[0x23D] != aot_test.rom[0x3D]);
+
+        Chip8 interpreter;
+        interpreter.load_rom(aot_test.rom);
+        interpreter.run(1000);
+        expect(same_state(interpreter, translated));
+    };
+
+    "check programs only run their own rom"_test = [] {
+        const std::vector<u8> rom{0x60, 0x07, 0x12, 0x02};
+        Chip8 interpreter;
+        interpreter.load_rom(rom);
+        Chip8 translated;
+        translated.set_program(&aot_test);
+        translated.load_rom(rom);
+        interpreter.run(10);
+        translated.run(10);
+        expect(same_state(interpreter, translated));
+    };
+};
+
+int main() {}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <boost/ut.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "../src/audio.h"
+#include "../src/common.h"
+#include "../src/spsc_ring.h"
+
+namespace fs = std::filesystem;
+
+boost::ut::suite audio = [] {
+    using namespace boost::ut;
+
+    "check the ring keeps order across threads"_test = [] {
+        SpscRing<u32> ring{16};
+        expect(eq(ring.capacity(), 16u));
+        constexpr u32 count = 100000;
+
+        std::thread producer{[&ring] {
+            for (u32 i = 0; i < count;) {
+                if (ring.push(i)) {
+                    ++i;
+                } else {
+                    // let the consumer run on a single cpu
+                    std::this_thread::yield();
+                }
+            }
+        }};
+        bool in_order = true;
+        for (u32 expected = 0; expected < count;) {
+            auto value = 0u;
+            if (ring.pop(value)) {
+                in_order &= value == expected;
+                ++expected;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        producer.join();
+
+        expect(in_order);
+        auto value = 0u;
+        expect(!ring.pop(value));
+    };
+
+    "check the beep follows the sound timer"_test = [] {
+        AudioOutput output{AudioConfig{.buffer_samples = 64}};
+        std::vector<float> buffer(64);
+
+        output.fill(buffer);
+        expect(std::ranges::all_of(buffer, [](float s) { return s == 0.0f; }));
+
+        output.report_sound_timer(10);
+        // later frames with the timer still running queue nothing
+        output.report_sound_timer(9);
+        output.fill(buffer);
+        expect(std::ranges::any_of(buffer, [](float s) { return s > 0.0f; }));
+        expect(std::ranges::any_of(buffer, [](float s) { return s < 0.0f; }));
+
+        output.report_sound_timer(0);
+        output.fill(buffer);
+        expect(std::ranges::all_of(buffer, [](float s) { return s == 0.0f; }));
+
+        const auto stats = output.take_stats();
+        expect(eq(stats.buffers, 3u));
+        expect(eq(stats.changes, 2u));
+        // at least the time to play one buffer
+        expect(stats.max_latency >= std::chrono::microseconds{1451});
+    };
+
+    "check the wav sink records the beep"_test = [] {
+        const auto path = fs::temp_directory_path() / "chip8_audio.wav";
+        AudioOutput output{AudioConfig{.buffer_samples = 256}};
+        {
+            WavFileAudioSink sink{path};
+            expect(eq(sink.start(output), 0u));
+            output.report_sound_timer(30);
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            sink.stop();
+        }
+
+        std::ifstream file{path, std::ios::binary};
+        std::vector<char> bytes{std::istreambuf_iterator<char>{file}, {}};
+        expect(bytes.size() > 44u);
+        expect(std::string(bytes.data(), 4) == "RIFF");
+        u32 data_size = 0;
+        std::copy_n(bytes.data() + 40, sizeof(data_size),
+                    reinterpret_cast<char *>(&data_size));
+        expect(eq(data_size, bytes.size() - 44));
+        expect(output.take_stats().changes == 1u);
+        fs::remove(path);
+    };
+};
+
+int main() {}
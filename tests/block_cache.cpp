@@ -0,0 +1,150 @@
+#include <boost/ut.hpp>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/jit_x64.h"
+
+namespace {
+
+bool same_state(const Chip8 &a, const Chip8 &b) {
+    return a.save_state() == b.save_state();
+}
+
+// the block cache and the jit both run basic blocks, these hold for either
+void test_blocks(Chip8::Backend backend) {
+    using namespace boost::ut;
+
+    "check blocks match the interpreter"_test = [backend] {
+        // draws the font characters across the screen in a loop
+        const std::vector<u8> rom{
+            0x60, 0x00, // 200: V0 = 0
+            0x61, 0x00, // 202: V1 = 0
+            0xA0, 0x50, // 204: I = font start
+            0xD0, 0x15, // 206: draw 5 rows at V0, V1
+            0x70, 0x05, // 208: V0 += 5
+            0x71, 0x03, // 20A: V1 += 3
+            0x83, 0x01, // 20C: V3 |= V0
+            0x85, 0x12, // 20E: V5 &= V1
+            0x86, 0x33, // 210: V6 ^= V3
+            0x87, 0x60, // 212: V7 = V6
+            0x79, 0x01, // 214: V9 += 1
+            0x22, 0x1C, // 216: call 21C
+            0x12, 0x04, // 218: jump 204
+            0x00, 0x00, // 21A
+            0x84, 0x13, // 21C: V4 ^= V1
+            0x00, 0xEE, // 21E: return
+        };
+
+        Chip8 interpreter;
+        interpreter.load_rom(rom);
+        Chip8 cached;
+        cached.set_backend(backend);
+        cached.load_rom(rom);
+
+        // uneven slices so budgets end in the middle of blocks
+        for (auto slice : {1u, 3u, 7u, 10u, 64u, 500u}) {
+            expect(eq(interpreter.run(slice), slice));
+            expect(eq(cached.run(slice), slice));
+            expect(same_state(interpreter, cached));
+        }
+    };
+
+    "check writes into cached code invalidate it"_test = [backend] {
+        const std::vector<u8> rom{
+            0x6A, 0x12, // 200: VA = 0x12
+            0x60, 0x6B, // 202: V0 = 0x6B
+            0x61, 0x77, // 204: V1 = 0x77
+            0xA2, 0x0C, // 206: I = 20C
+            0xF1, 0x55, // 208: store V0, V1 at 20C, making it 6B77
+            0x6B, 0x00, // 20A: VB = 0
+            0x6B, 0x11, // 20C: VB = 0x11, overwritten above
+            0x12, 0x0E, // 20E: jump to self
+        };
+
+        Chip8 interpreter;
+        interpreter.load_rom(rom);
+        Chip8 cached;
+        cached.set_backend(backend);
+        cached.load_rom(rom);
+        // build the block before the store runs
+        cached.run(1);
+        interpreter.run(1);
+
+        interpreter.run(20);
+        cached.run(20);
+        expect(eq(cached.V(0xB), 0x77));
+        expect(same_state(interpreter, cached));
+    };
+
+    "check loading a rom replaces cached code"_test = [backend] {
+        Chip8 cached;
+        cached.set_backend(backend);
+        cached.load_rom(std::vector<u8>{0x60, 0x01, 0x12, 0x00});
+        cached.run(4);
+        expect(eq(cached.V(0x0), 0x01));
+
+        auto state = cached.save_state();
+        state.pc = Chip8::ROM_START;
+        cached.load_state(state);
+        cached.load_rom(std::vector<u8>{0x60, 0x02, 0x12, 0x00});
+        cached.run(4);
+        expect(eq(cached.V(0x0), 0x02));
+    };
+
+    "check running off the end of memory halts"_test = [backend] {
+        Chip8 cached;
+        cached.set_backend(backend);
+        cached.execute(0x1FFA);
+        expect(eq(cached.run(10), 3u));
+        expect(eq(cached.pc(), 0x1000));
+    };
+}
+
+} // namespace
+
+boost::ut::suite block_cache = [] {
+    using namespace boost::ut;
+
+    "block cache"_test = [] { test_blocks(Chip8::Backend::block_cache); };
+    if (Jit::supported()) {
+        "jit"_test = [] { test_blocks(Chip8::Backend::jit); };
+    }
+
+    "check superinstructions match running one by one"_test = [] {
+        const std::vector<u8> rom{
+            0x60, 0x00, // 200: V0 = 0
+            0x61, 0x00, // 202: V1 = 0
+            0x62, 0x00, // 204: V2 = 0
+            0xA0, 0x50, // 206: I = font start
+            0xD0, 0x15, // 208: draw 5 rows at V0, V1, setting VF
+            0x70, 0x07, // 20A: V0 += 7
+            0x72, 0x01, // 20C: V2 += 1
+            0x32, 0x05, // 20E: skip if V2 == 5
+            0x12, 0x06, // 210: jump 206
+            0x71, 0x05, // 212: V1 += 5
+            0x12, 0x04, // 214: jump 204
+        };
+
+        Chip8 interpreter;
+        interpreter.load_rom(rom);
+        Chip8 fused;
+        fused.set_backend(Chip8::Backend::block_cache);
+        fused.load_rom(rom);
+        Chip8 unfused;
+        unfused.set_backend(Chip8::Backend::block_cache);
+        unfused.set_fusion(false);
+        unfused.load_rom(rom);
+
+        // uneven slices so budgets end in the middle of superinstructions
+        for (auto slice : {1u, 2u, 3u, 5u, 7u, 64u, 500u}) {
+            expect(eq(interpreter.run(slice), slice));
+            expect(eq(fused.run(slice), slice));
+            expect(eq(unfused.run(slice), slice));
+            expect(same_state(interpreter, fused));
+            expect(same_state(interpreter, unfused));
+        }
+    };
+};
+
+int main() {}
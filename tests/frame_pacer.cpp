@@ -0,0 +1,79 @@
+#include <boost/ut.hpp>
+#include <chrono>
+
+#include "../src/common.h"
+#include "../src/frame_pacer.h"
+
+boost::ut::suite frame_pacer = [] {
+    using namespace boost::ut;
+    using namespace std::chrono_literals;
+    using clock = FramePacer::clock;
+
+    const auto start = clock::time_point{} + 10s;
+
+    "check first tick is due at start"_test = [start] {
+        FramePacer pacer{60};
+        pacer.start(start);
+        expect(eq(pacer.due(start - 1ms), 0u));
+        expect(eq(pacer.due(start), 1u));
+        expect(pacer.next_tick() == start + pacer.period());
+        expect(eq(pacer.due(start + 1ms), 0u));
+    };
+
+    "check short stalls are caught up"_test = [start] {
+        FramePacer pacer{60, 5};
+        pacer.start(start);
+        pacer.due(start);
+        // three periods late, so the ticks at 1, 2 and 3 periods are due
+        expect(eq(pacer.due(start + pacer.period() * 3), 3u));
+        expect(pacer.next_tick() == start + pacer.period() * 4);
+
+        const auto stats = pacer.take_stats();
+        expect(eq(stats.ticks, u64{4}));
+        expect(eq(stats.dropped_ticks, u64{0}));
+        expect(stats.max_lateness == pacer.period() * 2);
+    };
+
+    "check long stalls drop the backlog"_test = [start] {
+        FramePacer pacer{60, 5};
+        pacer.start(start);
+        const auto late = start + 1s;
+        expect(eq(pacer.due(late), 1u));
+        expect(pacer.next_tick() == late + pacer.period());
+
+        const auto stats = pacer.take_stats();
+        expect(eq(stats.ticks, u64{1}));
+        expect(eq(stats.dropped_ticks, u64{60}));
+        expect(eq(pacer.take_stats().ticks, u64{0}));
+    };
+
+    "check ticks stay on schedule"_test = [start] {
+        FramePacer pacer{60};
+        pacer.start(start);
+        auto ticks = 0u;
+        for (auto ms = 0; ms < 1000; ++ms) {
+            ticks += pacer.due(start + std::chrono::milliseconds{ms});
+        }
+        expect(eq(ticks, 60u));
+    };
+
+    "check frame skip shows every nth frame"_test = [start] {
+        FrameSkip skip{4};
+        auto shown = 0u;
+        for (auto frame = 0u; frame < 20; ++frame) {
+            shown += skip.show(start) ? 1u : 0u;
+        }
+        expect(eq(shown, 5u));
+    };
+
+    "check frame skip shows one frame per display period"_test = [start] {
+        FrameSkip skip{0, 60};
+        expect(skip.show(start));
+        expect(!skip.show(start + 1ms));
+        expect(!skip.show(start + 16ms));
+        expect(skip.show(start + 17ms));
+        expect(!skip.show(start + 18ms));
+    };
+};
+
+int main() {}
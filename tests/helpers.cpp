@@ -2,6 +2,7 @@
 
 #include "../src/chip8.h"
 #include "../src/common.h"
+#include "../src/trace.h"
 
 boost::ut::suite helpers = [] {
     using namespace boost::ut;
@@ -40,6 +41,31 @@ boost::ut::suite helpers = [] {
             eq(byte_to_bitmap(0x90), std::array{true, false, false, true, false,
                                                 false, false, false}));
     };
+
+    "check pack_screen and pixel"_test = [] {
+        auto bitmap = Chip8::ScreenBitmap{std::array<bool, 64>{false}};
+        bitmap[0][0] = true;
+        bitmap[0][63] = true;
+        bitmap[31][1] = true;
+        const auto packed = Chip8::pack_screen(bitmap);
+
+        expect(eq(packed[0], u64{0x8000000000000001}));
+        expect(eq(packed[1], u64{0x0}));
+        expect(eq(packed[31], u64{0x4000000000000000}));
+        expect(Chip8::pixel(packed, 0, 0));
+        expect(Chip8::pixel(packed, 0, 63));
+        expect(Chip8::pixel(packed, 31, 1));
+        expect(!Chip8::pixel(packed, 31, 0));
+    };
+
+    "check trace categories can be toggled"_test = [] {
+        trace::enable(trace::Category::draw, false);
+        expect(!trace::enabled(trace::Category::draw));
+        expect(trace::enabled(trace::Category::fetch));
+
+        trace::enable(trace::Category::draw);
+        expect(trace::enabled(trace::Category::draw));
+    };
 };
 
 int main() {}
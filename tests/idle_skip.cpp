@@ -0,0 +1,74 @@
+#include <boost/ut.hpp>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+
+namespace {
+
+struct Run {
+    Chip8::State state;
+    u64 executed = 0;
+    u64 skipped = 0;
+};
+
+// runs @param rom for 120 frames of 37 instructions, pressing key 3 in
+// frame 60
+Run run(const std::vector<u8> &rom, Chip8::Backend backend, bool idle_skip) {
+    Chip8 chip8;
+    chip8.set_backend(backend);
+    chip8.set_idle_skip(idle_skip);
+    chip8.load_rom(rom);
+    auto result = Run{};
+    for (auto frame = 0u; frame < 120; ++frame) {
+        chip8.set_keys(frame == 60 ? 0x0008 : 0x0);
+        result.executed += chip8.run(37);
+        chip8.tick_timers();
+    }
+    result.state = chip8.save_state();
+    result.skipped = chip8.idle_cycles_skipped();
+    return result;
+}
+
+} // namespace
+
+boost::ut::suite idle_skip = [] {
+    using namespace boost::ut;
+
+    const std::vector<std::vector<u8>> roms = {
+        // jump to self
+        {0x60, 0x05, 0x12, 0x02},
+        // wait for a key, then jump to self
+        {0xF3, 0x0A, 0x12, 0x02},
+        // wait 50 frames on the delay timer, then count forever
+        {0x60, 0x32, 0xF0, 0x15, 0xF1, 0x07, 0x31, 0x00, 0x12, 0x04, 0x72,
+         0x01, 0x12, 0x0A},
+        // wait while the delay timer is 0, forever
+        {0xF1, 0x07, 0x41, 0x00, 0x12, 0x00},
+    };
+
+    "check skipping idle loops leaves the same state"_test = [&roms] {
+        for (const auto backend :
+             {Chip8::Backend::interpreter, Chip8::Backend::block_cache,
+              Chip8::Backend::jit}) {
+            for (const auto &rom : roms) {
+                const auto skipped = run(rom, backend, true);
+                const auto executed = run(rom, backend, false);
+                expect(skipped.state == executed.state);
+                expect(eq(skipped.executed, executed.executed));
+                expect(skipped.skipped > 0u);
+                expect(eq(executed.skipped, 0u));
+            }
+        }
+    };
+
+    "check busy loops which change state are not skipped"_test = [] {
+        // counts in V0 forever
+        const std::vector<u8> counting = {0x70, 0x01, 0x12, 0x00};
+        const auto result = run(counting, Chip8::Backend::interpreter, true);
+        expect(eq(result.skipped, 0u));
+        expect(eq(result.state.V[0], (120 * 37 / 2) % 256));
+    };
+};
+
+int main() {}
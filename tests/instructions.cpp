@@ -1,11 +1,37 @@
 #include <boost/ut.hpp>
+#include <memory>
 
 #include "../src/chip8.h"
 #include "../src/common.h"
+#include "../src/jit_x64.h"
 
-boost::ut::suite instructions = [] {
+namespace {
+
+/// A Chip8 whose execute() goes through @param backend, the interpreter or
+/// a block translated by the jit
+class Target : public Chip8 {
+  public:
+    explicit Target(Backend backend) {
+        if (backend == Backend::jit) {
+            jit_ = std::make_unique<Jit>();
+        }
+    }
+
+    void execute(u16 opcode) noexcept {
+        if (jit_) {
+            jit_->execute(*this, opcode);
+        } else {
+            Chip8::execute(opcode);
+        }
+    }
+
+  private:
+    std::unique_ptr<Jit> jit_;
+};
+
+void test_instructions(Chip8::Backend backend) {
     using namespace boost::ut;
-    Chip8 chip8;
+    Target chip8{backend};
     chip8.set_debug_level(spdlog::level::debug);
 
     // Execute machine instruction at 0xNNN, which is unimplemented
@@ -72,6 +98,20 @@ boost::ut::suite instructions = [] {
         expect(eq(chip8.pc(), 0x0D1E));
     };
 
+    // Skip the next instruction if VX equals, or does not equal, 0xNN
+    "3XNN 4XNN"_test = [&chip8] {
+        chip8.execute(0x1400);
+        chip8.execute(0x6742);
+        chip8.execute(0x3742);
+        expect(eq(chip8.pc(), 0x0402));
+        chip8.execute(0x3743);
+        expect(eq(chip8.pc(), 0x0402));
+        chip8.execute(0x4742);
+        expect(eq(chip8.pc(), 0x0402));
+        chip8.execute(0x4743);
+        expect(eq(chip8.pc(), 0x0404));
+    };
+
     // Store number 0xNN in register VX
     "6XNN"_test = [&chip8] {
         chip8.execute(0x6015);
@@ -502,16 +542,158 @@ boost::ut::suite instructions = [] {
         const auto screen = chip8.screen();
         for (auto row = 0; row < 32; ++row) {
             for (auto col = 0; col < 64; ++col) {
-                if (differences[row][col]) {
+                if (Chip8::pixel(differences, row, col)) {
                     spdlog::debug("Difference at row {} and col {}", row, col);
                     spdlog::debug("screen[{}][{}] = {}", row, col,
-                                  screen[row][col]);
+                                  Chip8::pixel(screen, row, col));
                     spdlog::debug("expected[{}][{}] = {}", row, col,
                                   expected[row][col]);
                 }
             }
         }
     };
+
+    // Skip the next instruction if the key in VX is held, or not held
+    "EX9E EXA1"_test = [&chip8] {
+        chip8.execute(0x1300);
+        chip8.execute(0x6A0C);
+        chip8.set_keys(0x1000);
+        chip8.execute(0xEA9E);
+        expect(eq(chip8.pc(), 0x0302));
+        chip8.execute(0xEAA1);
+        expect(eq(chip8.pc(), 0x0302));
+
+        chip8.set_keys(0x0001);
+        chip8.execute(0xEA9E);
+        expect(eq(chip8.pc(), 0x0302));
+        chip8.execute(0xEAA1);
+        expect(eq(chip8.pc(), 0x0304));
+        chip8.set_keys(0x0);
+    };
+
+    // Wait for a key and store it in VX
+    "FX0A"_test = [&chip8] {
+        chip8.execute(0x1302);
+        chip8.execute(0x6B00);
+        // without a key the instruction repeats
+        chip8.execute(0xFB0A);
+        expect(eq(chip8.pc(), 0x0300));
+        expect(eq(chip8.V(0xB), 0x00));
+
+        chip8.set_keys(0x0280);
+        chip8.execute(0xFB0A);
+        expect(eq(chip8.pc(), 0x0300));
+        expect(eq(chip8.V(0xB), 0x07));
+        chip8.set_keys(0x0);
+    };
+
+    // Set the delay timer to VX and read it back into VY
+    "FX15 FX07"_test = [&chip8] {
+        chip8.execute(0x6342);
+        chip8.execute(0xF315);
+        expect(eq(chip8.delay(), 0x42));
+
+        chip8.execute(0xF407);
+        expect(eq(chip8.V(0x4), 0x42));
+
+        chip8.tick_timers();
+        chip8.execute(0xF507);
+        expect(eq(chip8.V(0x5), 0x41));
+    };
+
+    // Set the sound timer to VX
+    "FX18"_test = [&chip8] {
+        chip8.execute(0x6602);
+        chip8.execute(0xF618);
+        expect(eq(chip8.sound(), 0x02));
+
+        // both timers stop at zero
+        chip8.execute(0x6001);
+        chip8.execute(0xF015);
+        chip8.tick_timers();
+        chip8.tick_timers();
+        chip8.tick_timers();
+        expect(eq(chip8.sound(), 0x00));
+        expect(eq(chip8.delay(), 0x00));
+    };
+
+    // Store the binary coded decimal value of VX at I, I + 1 and I + 2
+    "FX33"_test = [&chip8] {
+        chip8.execute(0xA300);
+        chip8.execute(0x6E9C);
+        chip8.execute(0xFE33);
+        expect(eq(chip8.memory()[0x300], 1));
+        expect(eq(chip8.memory()[0x301], 5));
+        expect(eq(chip8.memory()[0x302], 6));
+        expect(eq(chip8.I(), 0x300));
+    };
+
+    // Store V0 to VX in memory starting at I and load them back
+    "FX55 FX65"_test = [&chip8] {
+        chip8.execute(0xA400);
+        for (u8 X = 0; X < 16; ++X) {
+            chip8.execute(0x6000 + (X << 8) + X * 3);
+        }
+        chip8.execute(0xF755);
+        for (u8 X = 0; X < 8; ++X) {
+            expect(eq(chip8.memory()[0x400 + X], X * 3));
+        }
+        expect(eq(chip8.memory()[0x408], 0));
+        expect(eq(chip8.I(), 0x400));
+
+        for (u8 X = 0; X < 16; ++X) {
+            chip8.execute(0x6000 + (X << 8));
+        }
+        chip8.execute(0xF565);
+        for (u8 X = 0; X < 6; ++X) {
+            expect(eq(chip8.V(X), X * 3));
+        }
+        expect(eq(chip8.V(0x6), 0));
+    };
+
+    // Opcodes outside the instruction set
+    "unknown opcodes"_test = [&chip8] {
+        for (const u16 opcode : {0x5121, 0x800F, 0x9AB1, 0xE0FF, 0xF0FF}) {
+            chip8.execute(opcode);
+            expect(chip8.bad_opcode());
+            chip8.execute(0x6000);
+            expect(!chip8.bad_opcode());
+        }
+    };
+}
+
+} // namespace
+
+boost::ut::suite instructions = [] {
+    using namespace boost::ut;
+
+    "interpreter"_test = [] { test_instructions(Chip8::Backend::interpreter); };
+    if (Jit::supported()) {
+        "jit"_test = [] { test_instructions(Chip8::Backend::jit); };
+    }
+
+    // The dispatch table and the switch run the same handlers
+    "dispatch table matches switch"_test = [] {
+        Chip8 table;
+        table.execute(0xA300);
+        for (u8 X = 0; X < 16; ++X) {
+            table.execute(0x6000 + (X << 8) + X * 17 + 3);
+        }
+        const auto initial = table.save_state();
+
+        Chip8 switched;
+        auto mismatches = 0u;
+        for (auto opcode = 0u; opcode <= 0xFFFF; ++opcode) {
+            table.load_state(initial);
+            switched.load_state(initial);
+            table.execute(static_cast<u16>(opcode));
+            switched.execute_switch(static_cast<u16>(opcode));
+            if (table.save_state() != switched.save_state()) {
+                ++mismatches;
+            }
+        }
+        expect(eq(mismatches, 0u));
+    };
 };
 
 int main() {}
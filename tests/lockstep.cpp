@@ -0,0 +1,139 @@
+#include <boost/ut.hpp>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/lockstep.h"
+
+namespace {
+
+Chip8::State initial_state(const std::vector<u8> &rom) {
+    Chip8 chip8;
+    chip8.load_rom(rom);
+    return chip8.save_state();
+}
+
+// runs @param state on its own for @param cycles in frames of 10
+Chip8::State reference(const Chip8::State &state, u32 cycles) {
+    Chip8 chip8;
+    chip8.load_state(state);
+    for (auto done = 0u; done < cycles; done += 10) {
+        chip8.run(10);
+        chip8.tick_timers();
+    }
+    return chip8.save_state();
+}
+
+} // namespace
+
+boost::ut::suite lockstep = [] {
+    using namespace boost::ut;
+
+    const std::vector<u8> rom{
+        0x71, 0x01, // 200: V1 += 1
+        0x82, 0x13, // 202: V2 ^= V1
+        0x83, 0x21, // 204: V3 |= V2
+        0xF3, 0x15, // 206: delay = V3
+        0xA3, 0x00, // 208: I = 300
+        0xF3, 0x33, // 20A: store the BCD of V3 at 300
+        0xF4, 0x07, // 20C: V4 = delay
+        0x80, 0x42, // 20E: V0 &= V4
+        0x12, 0x00, // 210: jump 200
+    };
+
+    "check lanes match separate machines"_test = [&rom] {
+        const auto initial = initial_state(rom);
+        // more than one block of lanes, and not a multiple of one
+        Lockstep engine(initial, 45);
+        for (auto lane = 0u; lane < engine.lanes(); ++lane) {
+            auto state = initial;
+            state.V[0x0] = 0xFF;
+            state.V[0x1] = static_cast<u8>(lane * 7);
+            engine.set_state(lane, state);
+        }
+        for (auto frame = 0u; frame < 30; ++frame) {
+            expect(eq(engine.run(10), 10u));
+            engine.tick_timers();
+        }
+
+        for (auto lane = 0u; lane < engine.lanes(); ++lane) {
+            auto state = initial;
+            state.V[0x0] = 0xFF;
+            state.V[0x1] = static_cast<u8>(lane * 7);
+            expect(engine.state(lane) == reference(state, 300));
+        }
+        expect(engine.stats().vector_instructions > 0u);
+    };
+
+    "check diverged lanes rejoin"_test = [] {
+        const std::vector<u8> rom{
+            0x60, 0x01, // 200: V0 = 1
+            0x61, 0x02, // 202: V1 = 2
+            0x62, 0x03, // 204: V2 = 3
+            0x12, 0x08, // 206: jump 208
+            0x12, 0x08, // 208: jump to self
+        };
+        const auto initial = initial_state(rom);
+        Lockstep engine(initial, 40);
+        // every third lane starts two instructions ahead
+        for (auto lane = 0u; lane < engine.lanes(); lane += 3) {
+            auto state = initial;
+            state.pc = 0x204;
+            engine.set_state(lane, state);
+        }
+
+        engine.run(4);
+        const auto before = engine.stats();
+        expect(before.scalar_instructions > 0u);
+        engine.run(10);
+        const auto after = engine.stats();
+        // all lanes spin on the same jump now
+        expect(eq(after.scalar_instructions, before.scalar_instructions));
+        expect(eq(after.vector_instructions,
+                  before.vector_instructions + 10u * engine.lanes()));
+        for (auto lane = 0u; lane < engine.lanes(); ++lane) {
+            expect(eq(engine.state(lane).pc, 0x208));
+        }
+    };
+
+    "check stores into code split the group"_test = [] {
+        const std::vector<u8> rom{
+            0xA2, 0x08, // 200: I = 208
+            0xF1, 0x55, // 202: store V0, V1 at 208
+            0x00, 0x00, // 204
+            0x00, 0x00, // 206
+            0x6A, 0x00, // 208: replaced by the store above
+            0x6B, 0x01, // 20A: VB = 1
+            0x12, 0x0C, // 20C: jump to self
+        };
+        const auto initial = initial_state(rom);
+        Lockstep engine(initial, 33);
+        for (auto lane = 0u; lane < engine.lanes(); ++lane) {
+            auto state = initial;
+            state.pc = 0x202;
+            state.I = 0x208;
+            // odd lanes turn 208 into a jump over 20A
+            state.V[0x0] = lane % 2 ? 0x12 : 0x6A;
+            state.V[0x1] = lane % 2 ? 0x0C : static_cast<u8>(lane);
+            engine.set_state(lane, state);
+        }
+        engine.run(8);
+
+        for (auto lane = 0u; lane < engine.lanes(); ++lane) {
+            const auto state = engine.state(lane);
+            expect(eq(state.pc, 0x20C));
+            expect(eq(state.V[0xA], lane % 2 ? 0x00 : lane));
+            expect(eq(state.V[0xB], lane % 2 ? 0x00 : 0x01));
+        }
+    };
+
+    "check halted lanes stop the run"_test = [] {
+        Chip8 chip8;
+        chip8.execute(0x1FFA);
+        Lockstep engine(chip8.save_state(), 3);
+        expect(eq(engine.run(10), 3u));
+        expect(eq(engine.state(2).pc, 0x1000));
+    };
+};
+
+int main() {}
@@ -0,0 +1,107 @@
+#include <boost/ut.hpp>
+#include <filesystem>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/movie.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// waits for a key into V0, then counts in V1 while it stays held
+const std::vector<u8> COUNT_WHILE_HELD = {
+    0xF0, 0x0A, // 200: V0 = key
+    0xE0, 0x9E, // 202: skip if V0 held
+    0x12, 0x00, // 204: jump 200
+    0x71, 0x01, // 206: V1 += 1
+    0x12, 0x02, // 208: jump 202
+};
+
+Movie make_movie() {
+    auto movie = Movie{.rom_hash = fnv1a(COUNT_WHILE_HELD),
+                       .instructions_per_frame = 7,
+                       .keys = {}};
+    for (auto frame = 0u; frame < 300; ++frame) {
+        // key 5 held for a while, then key 9 held on and off
+        movie.keys.push_back(frame < 40    ? 0x0
+                             : frame < 90  ? 0x0020
+                             : frame % 7 < 3 ? 0x0200
+                                             : 0x0);
+    }
+    return movie;
+}
+
+Chip8::State replay(const Movie &movie, Chip8::Backend backend) {
+    Chip8 chip8;
+    chip8.set_backend(backend);
+    chip8.load_rom(COUNT_WHILE_HELD);
+    play_movie(chip8, movie);
+    return chip8.save_state();
+}
+
+} // namespace
+
+boost::ut::suite movie = [] {
+    using namespace boost::ut;
+
+    "check movie files round trip"_test = [] {
+        const auto path = fs::temp_directory_path() / "chip8_movie.c8m";
+        const auto movie = make_movie();
+        expect(write_movie_file(path, movie));
+        // runs of the same keys are stored once
+        expect(fs::file_size(path) < movie.keys.size());
+
+        const auto loaded = read_movie_file(path);
+        expect(loaded.has_value());
+        if (loaded) {
+            expect(eq(loaded->rom_hash, movie.rom_hash));
+            expect(eq(loaded->instructions_per_frame, 7u));
+            expect(eq(loaded->variant, movie.variant));
+            expect(eq(loaded->quirks, movie.quirks));
+            expect(loaded->keys == movie.keys);
+        }
+        fs::remove(path);
+    };
+
+    "check the header is written field by field"_test = [] {
+        const auto path = fs::temp_directory_path() / "chip8_movie_header.c8m";
+        auto movie = make_movie();
+        movie.variant = XoChip::VARIANT;
+        movie.quirks = XoChip::QUIRKS;
+        movie.keys.clear();
+        expect(write_movie_file(path, movie));
+        // magic, version, hash, three counts and two names, no padding
+        expect(eq(fs::file_size(path), 4u + 4u + 8u + 3u * 4u + 1u +
+                                           movie.variant.size() + 1u +
+                                           movie.quirks.size()));
+
+        const auto loaded = read_movie_file(path);
+        expect(loaded.has_value());
+        if (loaded) {
+            expect(recorded_on<XoChip>(*loaded));
+            expect(!recorded_on<Chip8>(*loaded));
+            expect(!recorded_on<Chip8Core<variant::Chip8, quirks::Cosmac>>(
+                *loaded));
+        }
+        fs::remove(path);
+    };
+
+    "check replays are identical on every backend"_test = [] {
+        const auto movie = make_movie();
+        const auto state = replay(movie, Chip8::Backend::interpreter);
+        expect(state.V[0x0] == 0x9);
+        expect(state.V[0x1] > 0x0);
+
+        expect(replay(movie, Chip8::Backend::interpreter) == state);
+        expect(replay(movie, Chip8::Backend::block_cache) == state);
+        expect(replay(movie, Chip8::Backend::jit) == state);
+
+        auto other = movie;
+        other.keys[100] = 0x0;
+        expect(!(replay(other, Chip8::Backend::interpreter) == state));
+    };
+};
+
+int main() {}
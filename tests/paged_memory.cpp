@@ -0,0 +1,67 @@
+#include <boost/ut.hpp>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/paged_memory.h"
+
+boost::ut::suite paged_memory = [] {
+    using namespace boost::ut;
+
+    "check writes copy only their page"_test = [] {
+        const std::vector<u8> rom{0x60, 0x12, 0xA3, 0x00,
+                                  0xF0, 0x55, 0x12, 0x06};
+        const auto image = SharedChip8::make_image(rom);
+
+        SharedChip8 first;
+        SharedChip8 second;
+        first.share_memory(image);
+        second.share_memory(image);
+        expect(eq(first.memory().private_pages(), 0u));
+        expect(eq(first.memory()[Chip8::ROM_START], 0x60));
+
+        // FX55 stores V0 to 0x300
+        first.run(3);
+        expect(eq(first.memory()[0x300], 0x12));
+        expect(eq(first.memory().private_pages(), 1u));
+        expect(eq(second.memory()[0x300], 0x0));
+        expect(eq(second.memory().private_pages(), 0u));
+        expect(eq((*image)[0x300], 0x0));
+    };
+
+    "check loading a state keeps matching pages shared"_test = [] {
+        SharedChip8 chip8;
+        chip8.share_memory(
+            SharedChip8::make_image(std::vector<u8>{0x60, 0x12}));
+        auto state = chip8.save_state();
+        expect(eq(state.memory[Chip8::ROM_START], 0x60));
+        expect(eq(state.memory[0x50], 0xF0));
+
+        state.memory[0xFFF] = 0xAB;
+        chip8.load_state(state);
+        expect(eq(chip8.memory().private_pages(), 1u));
+        expect(chip8.save_state() == state);
+    };
+
+    "check flat memory copies a shared image"_test = [] {
+        const std::vector<u8> rom{0x60, 0x12, 0xA3, 0x00,
+                                  0xF0, 0x55, 0x12, 0x06};
+        const auto image = Chip8::make_image(rom);
+
+        Chip8 chip8;
+        chip8.share_memory(image);
+        chip8.run(3);
+        expect(eq(chip8.memory()[0x300], 0x12));
+        expect(eq((*image)[0x300], 0x0));
+    };
+
+    "check addresses wrap around memory"_test = [] {
+        PagedMemory memory;
+        memory.write(0x1001, 0x7F);
+        expect(eq(memory[0x1], 0x7F));
+        expect(eq(memory[0x1001], 0x7F));
+        expect(eq(memory.private_pages(), 1u));
+    };
+};
+
+int main() {}
@@ -0,0 +1,90 @@
+#include <array>
+#include <boost/ut.hpp>
+#include <sstream>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/profiler.h"
+
+boost::ut::suite profiler = [] {
+    using namespace boost::ut;
+
+    "check the profiler follows calls and returns"_test = [] {
+        auto profiler = Profiler::for_variant<variant::Chip8>();
+        const std::array<u16, 2> stack = {0x204, 0x302};
+        const auto frames = std::span<const u16>{stack};
+
+        profiler.record(0x200, 0x6001, frames.first(0));
+        profiler.record(0x202, 0x2300, frames.first(0));
+        // first instruction of the routine at 0x300
+        profiler.record(0x300, 0x2400, frames.first(1), 3);
+        profiler.record(0x400, 0x00EE, frames.first(2));
+        profiler.record(0x302, 0x00EE, frames.first(1));
+        profiler.record(0x204, 0x1204, frames.first(0), 5);
+
+        expect(eq(profiler.total(), 12u));
+        expect(eq(profiler.at(0x204), 5u));
+        expect(eq(profiler.at(0x300), 3u));
+        expect(eq(profiler.of(Op::_2NNN), 4u));
+        expect(eq(profiler.of(Op::_00EE), 2u));
+
+        std::ostringstream folded;
+        profiler.write_folded(folded);
+        expect(folded.str() == "main 7\n"
+                               "main;0x300 4\n"
+                               "main;0x300;0x400 1\n");
+
+        std::ostringstream report;
+        profiler.write_report(report, 1);
+        expect(report.str().starts_with("12 instructions\n"));
+        expect(report.str().find("0x204            5  41.67") !=
+               std::string::npos);
+
+        profiler.reset();
+        expect(eq(profiler.total(), 0u));
+        std::ostringstream empty;
+        profiler.write_folded(empty);
+        expect(empty.str().empty());
+    };
+
+    "check the profiler covers the memory and ops of its variant"_test = [] {
+        auto profiler = Profiler::for_variant<variant::XoChip>();
+        const std::array<u16, 0> frames = {};
+        profiler.record(0xF000, 0x00D1, frames);
+        profiler.record(0x1000, 0xF000, frames);
+        expect(eq(profiler.at(0xF000), 1u));
+        expect(eq(profiler.at(0x1000), 1u));
+        expect(eq(profiler.at(0x000), 0u));
+        expect(eq(profiler.of(Op::_00DN), 1u));
+        expect(eq(profiler.of(Op::_F000), 1u));
+    };
+
+    "check the profiler sees every instruction of a run"_test = [] {
+        if constexpr (!profile::COMPILED) {
+            return;
+        }
+        // calls 0x206 twice, which returns, then jumps to self
+        const std::vector<u8> rom = {0x22, 0x06, 0x22, 0x06, 0x12,
+                                     0x04, 0x70, 0x01, 0x00, 0xEE};
+        for (const auto backend :
+             {Chip8::Backend::interpreter, Chip8::Backend::block_cache,
+              Chip8::Backend::jit}) {
+            Chip8 chip8;
+            auto profiler = Profiler::for_variant<variant::Chip8>();
+            chip8.set_backend(backend);
+            chip8.set_profiler(&profiler);
+            chip8.load_rom(rom);
+            expect(eq(chip8.run(100), 100u));
+            expect(eq(profiler.total(), 100u));
+            expect(eq(profiler.at(0x206), 2u));
+            expect(eq(profiler.at(0x204), 94u));
+
+            std::ostringstream folded;
+            profiler.write_folded(folded);
+            expect(folded.str() == "main 96\nmain;0x206 4\n");
+        }
+    };
+};
+
+int main() {}
@@ -0,0 +1,86 @@
+#include <boost/ut.hpp>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+
+namespace {
+
+template <typename Quirks> using Profile = Chip8Core<variant::Chip8, Quirks>;
+
+template <typename Core> Core run_rom(const std::vector<u8> &rom, u32 cycles) {
+    Core chip8;
+    chip8.load_rom(rom);
+    chip8.run(cycles);
+    return chip8;
+}
+
+} // namespace
+
+boost::ut::suite quirks_tests = [] {
+    using namespace boost::ut;
+
+    "check shifts use VX or VY"_test = [] {
+        const std::vector<u8> rom{
+            0x60, 0x10, // 200: V0 = 0x10
+            0x61, 0x81, // 202: V1 = 0x81
+            0x80, 0x16, // 204: V0 >>= 1, or V0 = V1 >> 1
+            0x62, 0x10, // 206: V2 = 0x10
+            0x82, 0x1E, // 208: V2 <<= 1, or V2 = V1 << 1
+        };
+        const auto modern = run_rom<Chip8>(rom, 3);
+        expect(eq(modern.V(0), 0x08));
+        expect(eq(modern.V(0xF), 0));
+        const auto cosmac = run_rom<Profile<quirks::Cosmac>>(rom, 3);
+        expect(eq(cosmac.V(0), 0x40));
+        expect(eq(cosmac.V(0xF), 1));
+
+        expect(eq(run_rom<Chip8>(rom, 5).V(2), 0x20));
+        const auto shifted_vy = run_rom<Profile<quirks::Cosmac>>(rom, 5);
+        expect(eq(shifted_vy.V(2), 0x02));
+        expect(eq(shifted_vy.V(0xF), 1));
+    };
+
+    "check FX55 and FX65 move I past VX with the quirk"_test = [] {
+        const std::vector<u8> rom{
+            0xA3, 0x00, // 200: I = 300
+            0xF2, 0x55, // 202: store V0 to V2 at I
+            0xF1, 0x65, // 204: load V0 to V1 from I
+        };
+        expect(eq(run_rom<Chip8>(rom, 3).I(), 0x300));
+        expect(eq(run_rom<Profile<quirks::SuperChip>>(rom, 3).I(), 0x300));
+        expect(eq(run_rom<Profile<quirks::Cosmac>>(rom, 2).I(), 0x303));
+        expect(eq(run_rom<Profile<quirks::Cosmac>>(rom, 3).I(), 0x305));
+    };
+
+    "check BNNN jumps by V0 or VX"_test = [] {
+        const std::vector<u8> rom{
+            0x60, 0x04, // 200: V0 = 4
+            0x63, 0x08, // 202: V3 = 8
+            0xB3, 0x00, // 204: jump to 300 + V0, or 300 + V3
+        };
+        expect(eq(run_rom<Chip8>(rom, 3).pc(), 0x304));
+        expect(eq(run_rom<Profile<quirks::SuperChip>>(rom, 3).pc(), 0x308));
+    };
+
+    "check sprites clip or wrap at the edges"_test = [] {
+        const std::vector<u8> rom{
+            0xA0, 0x50, // 200: I = font 0, F0 90 90 90 F0
+            0x60, 0x3E, // 202: V0 = 62
+            0x61, 0x1E, // 204: V1 = 30
+            0xD0, 0x15, // 206: draw 5 rows at V0, V1
+        };
+        const auto clipped = run_rom<Chip8>(rom, 4);
+        expect(eq(clipped.screen()[30], 0x3u));
+        expect(eq(clipped.screen()[31], 0x2u));
+        expect(eq(clipped.screen()[0], 0u));
+
+        const auto wrapped = run_rom<Profile<quirks::XoChip>>(rom, 4);
+        expect(eq(wrapped.screen()[30], 0xC000000000000003u));
+        expect(eq(wrapped.screen()[31], 0x4000000000000002u));
+        expect(eq(wrapped.screen()[0], 0x4000000000000002u));
+        expect(eq(wrapped.screen()[2], 0xC000000000000003u));
+    };
+};
+
+int main() {}
@@ -0,0 +1,94 @@
+#include <boost/ut.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/rom.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+fs::path write_file(const std::string &name, const std::vector<u8> &bytes) {
+    const auto path = fs::temp_directory_path() / name;
+    std::ofstream file{path, std::ios::binary};
+    file.write(reinterpret_cast<const char *>(bytes.data()),
+               static_cast<std::streamsize>(bytes.size()));
+    return path;
+}
+
+} // namespace
+
+boost::ut::suite rom = [] {
+    using namespace boost::ut;
+
+    "check mapped roms load"_test = [] {
+        const std::vector<u8> bytes{0x60, 0x12, 0x12, 0x02};
+        const auto path = write_file("chip8_rom_small.ch8", bytes);
+
+        const auto rom = MappedRom::open(path);
+        expect(!rom.empty());
+        expect(eq(rom.bytes().size(), bytes.size()));
+        expect(eq(rom.hash(), fnv1a(bytes)));
+
+        Chip8 chip8;
+        chip8.load_rom(rom.bytes());
+        expect(eq(chip8.memory()[Chip8::ROM_START], 0x60));
+        expect(eq(chip8.memory()[Chip8::ROM_START + 3], 0x02));
+        fs::remove(path);
+    };
+
+    "check roms of the wrong size are rejected"_test = [] {
+        const auto empty = write_file("chip8_rom_empty.ch8", {});
+        expect(MappedRom::open(empty).empty());
+        fs::remove(empty);
+
+        const auto largest = write_file(
+            "chip8_rom_largest.ch8", std::vector<u8>(Chip8::MAX_ROM_SIZE, 1));
+        expect(!MappedRom::open(largest).empty());
+        fs::remove(largest);
+
+        const auto too_large =
+            write_file("chip8_rom_too_large.ch8",
+                       std::vector<u8>(Chip8::MAX_ROM_SIZE + 1, 1));
+        expect(MappedRom::open(too_large).empty());
+        fs::remove(too_large);
+
+        expect(MappedRom::open(fs::temp_directory_path() /
+                               "chip8_rom_missing.ch8")
+                   .empty());
+    };
+
+    "check the size limit follows the core"_test = [] {
+        const auto xochip = write_file(
+            "chip8_rom_xochip.ch8", std::vector<u8>(XoChip::MAX_ROM_SIZE, 1));
+        expect(MappedRom::open(xochip).empty());
+        expect(!MappedRom::open(xochip, XoChip::MAX_ROM_SIZE).empty());
+        fs::remove(xochip);
+    };
+
+    "check the library shares images by contents"_test = [] {
+        const auto first = write_file("chip8_rom_a.ch8", {0x00, 0xE0});
+        const auto copy = write_file("chip8_rom_b.ch8", {0x00, 0xE0});
+        const auto other = write_file("chip8_rom_c.ch8", {0x00, 0xEE});
+
+        RomLibrary library;
+        const auto a = library.load(first);
+        const auto b = library.load(copy);
+        const auto c = library.load(other);
+        expect(a != nullptr && c != nullptr);
+        expect(a == b);
+        expect(a != c);
+        expect(eq(library.size(), 2u));
+        expect(library.load(fs::temp_directory_path() /
+                            "chip8_rom_missing.ch8") == nullptr);
+
+        fs::remove(first);
+        fs::remove(copy);
+        fs::remove(other);
+    };
+};
+
+int main() {}
@@ -0,0 +1,139 @@
+#include <boost/ut.hpp>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+#include "../src/state_file.h"
+
+boost::ut::suite state = [] {
+    using namespace boost::ut;
+    namespace fs = std::filesystem;
+
+    "check save and load state"_test = [] {
+        Chip8 chip8;
+        chip8.execute(0x6A12);
+        chip8.execute(0xA050);
+        chip8.execute(0xD005);
+        chip8.execute(0x2300);
+        const auto saved = chip8.save_state();
+
+        chip8.execute(0x6A34);
+        chip8.execute(0x00E0);
+        chip8.execute(0x00EE);
+        expect(eq(chip8.V(0xA), 0x34));
+
+        chip8.load_state(saved);
+        expect(eq(chip8.V(0xA), 0x12));
+        expect(eq(chip8.I(), 0x050));
+        expect(eq(chip8.pc(), 0x300));
+        expect(eq(chip8.stack().size(), 1u));
+        expect(!chip8.screen_equal(Chip8::Screen{}));
+        expect(saved == chip8.save_state());
+    };
+
+    "check stack overflow and underflow"_test = [] {
+        Chip8 chip8;
+        chip8.execute(0x00EE);
+        expect(chip8.stack_fault());
+        expect(eq(chip8.pc(), 0x200));
+
+        Chip8 deep;
+        for (auto i = 0u; i < Chip8::STACK_SIZE; ++i) {
+            deep.execute(0x2400);
+        }
+        expect(!deep.stack_fault());
+        expect(eq(deep.stack().size(), 16u));
+
+        deep.execute(0x2600);
+        expect(deep.stack_fault());
+        expect(eq(deep.pc(), 0x400));
+        expect(eq(deep.stack().size(), 16u));
+    };
+
+    "check reset returns to power on"_test = [] {
+        const std::vector<u8> rom{0x6A, 0x12, 0xA2, 0x00, 0xFA, 0x55};
+        Chip8 chip8;
+        chip8.set_backend(Chip8::Backend::block_cache);
+        chip8.load_rom(rom);
+        chip8.run(3);
+        chip8.set_keys(0x1);
+
+        chip8.reset();
+        expect(Chip8{}.save_state() == chip8.save_state());
+        expect(chip8.backend() == Chip8::Backend::block_cache);
+        chip8.load_rom(rom);
+        expect(eq(chip8.run(3), 3u));
+        expect(eq(chip8.memory()[0x20A], 0x12));
+    };
+
+    "check state file round trip"_test = [] {
+        const auto path = fs::temp_directory_path() / "chip8_state_test.c8s";
+        Chip8 chip8;
+        chip8.execute(0x6BAB);
+        chip8.execute(0xFB15);
+        expect(write_state_file(path, chip8.save_state()));
+
+        const auto loaded = read_state_file(path);
+        expect(loaded.has_value());
+        if (loaded) {
+            Chip8 restored;
+            restored.load_state(*loaded);
+            expect(eq(restored.V(0xB), 0xAB));
+            expect(eq(restored.delay(), 0xAB));
+        }
+        fs::remove(path);
+    };
+
+    "check state file rejects other versions"_test = [] {
+        const auto path = fs::temp_directory_path() / "chip8_state_bad.c8s";
+        {
+            expect(write_state_file(path, Chip8::State{}));
+            std::fstream file{path, std::ios::binary | std::ios::in |
+                                        std::ios::out};
+            const auto version = STATE_FILE_VERSION + 1;
+            file.seekp(4);
+            file.write(reinterpret_cast<const char *>(&version),
+                       sizeof(version));
+        }
+        expect(!read_state_file(path).has_value());
+
+        {
+            std::ofstream file{path, std::ios::binary};
+            file << "not a state file at all";
+        }
+        expect(!read_state_file(path).has_value());
+        fs::remove(path);
+    };
+
+    "check state file rejects states the machine can not be in"_test = [] {
+        const auto path = fs::temp_directory_path() / "chip8_state_bad.c8s";
+        const auto state = Chip8::State{};
+        // magic and version, then the fields without padding
+        const auto sp_at = 4 + 4 + sizeof(state.screen) + sizeof(state.stack) +
+                           sizeof(state.V) + sizeof(state.pc) +
+                           sizeof(state.I);
+        const auto bad_opcode_at = sp_at + 1 + 1 + 1 + sizeof(state.keys);
+        expect(write_state_file(path, state));
+        expect(eq(fs::file_size(path),
+                  bad_opcode_at + 2 + sizeof(state.memory)));
+        expect(read_state_file(path).has_value());
+
+        const auto corrupt = [&path](std::size_t at, u8 value) {
+            std::fstream file{path, std::ios::binary | std::ios::in |
+                                        std::ios::out};
+            file.seekp(static_cast<std::streamoff>(at));
+            file.put(static_cast<char>(value));
+        };
+        corrupt(bad_opcode_at, 2);
+        expect(!read_state_file(path).has_value());
+        corrupt(bad_opcode_at, 1);
+        expect(read_state_file(path).has_value());
+        corrupt(sp_at, Chip8::STACK_SIZE + 1);
+        expect(!read_state_file(path).has_value());
+        fs::remove(path);
+    };
+};
+
+int main() {}
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <boost/ut.hpp>
+#include <chrono>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "../src/common.h"
+#include "../src/thread_pool.h"
+
+boost::ut::suite thread_pool = [] {
+    using namespace boost::ut;
+
+    "check every task runs once"_test = [] {
+        ThreadPool pool{4};
+        std::vector<u32> runs(1000, 0);
+        for (auto i = 0u; i < runs.size(); ++i) {
+            pool.submit([&runs, i] { ++runs[i]; });
+        }
+        pool.wait();
+
+        expect(std::ranges::all_of(runs, [](u32 r) { return r == 1; }));
+    };
+
+    "check uneven tasks are stolen"_test = [] {
+        ThreadPool pool{4};
+        std::atomic<u64> total = 0;
+        for (auto i = 0u; i < 64; ++i) {
+            // every fourth task lands on the same worker and is much longer
+            const auto work = (i % 4 == 0) ? 100000u : 10u;
+            pool.submit([&total, work] {
+                u64 sum = 0;
+                for (auto j = 0u; j < work; ++j) {
+                    sum += j % 3;
+                }
+                total += sum > 0 ? 1 : 0;
+            });
+        }
+        pool.wait();
+
+        expect(eq(total.load(), u64{64}));
+    };
+
+    "check a blocked worker's task is stolen"_test = [] {
+        ThreadPool pool{2};
+        // tasks are queued round robin, task i to worker i % 2. The first
+        // and third both go to worker 0 and each blocks until the other has
+        // started, so one of them has to be stolen by worker 1
+        std::atomic<u32> arrived = 0;
+        std::array<std::optional<u32>, 3> ran_on;
+        const auto meet = [&arrived] {
+            ++arrived;
+            const auto deadline =
+                std::chrono::steady_clock::now() + std::chrono::seconds{10};
+            while (arrived < 2 && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::yield();
+            }
+        };
+        pool.submit([&] {
+            ran_on[0] = ThreadPool::worker_index();
+            meet();
+        });
+        pool.submit([&] { ran_on[1] = ThreadPool::worker_index(); });
+        pool.submit([&] {
+            ran_on[2] = ThreadPool::worker_index();
+            meet();
+        });
+        pool.wait();
+
+        auto stolen = 0u;
+        for (auto i = 0u; i < ran_on.size(); ++i) {
+            expect(ran_on[i].has_value());
+            if (ran_on[i] != i % 2) {
+                ++stolen;
+            }
+        }
+        expect(stolen > 0u);
+        expect(ran_on[0] != ran_on[2]);
+        expect(!ThreadPool::worker_index().has_value());
+    };
+
+    "check wait with no tasks"_test = [] {
+        ThreadPool pool{2};
+        pool.wait();
+        expect(eq(pool.size(), 2u));
+    };
+};
+
+int main() {}
@@ -0,0 +1,67 @@
+#include <array>
+#include <boost/ut.hpp>
+#include <thread>
+
+#include "../src/common.h"
+#include "../src/triple_buffer.h"
+
+boost::ut::suite triple_buffer = [] {
+    using namespace boost::ut;
+
+    "check the reader gets the latest value"_test = [] {
+        TripleBuffer<u32> buffer;
+        expect(!buffer.update());
+
+        buffer.write_buffer() = 1;
+        buffer.publish();
+        buffer.write_buffer() = 2;
+        buffer.publish();
+        expect(eq(buffer.overwritten(), 1u));
+
+        expect(buffer.update());
+        expect(eq(buffer.read_buffer(), 2u));
+        expect(!buffer.update());
+        expect(eq(buffer.read_buffer(), 2u));
+
+        buffer.write_buffer() = 3;
+        buffer.publish();
+        expect(buffer.update());
+        expect(eq(buffer.read_buffer(), 3u));
+        expect(eq(buffer.published(), 3u));
+    };
+
+    "check values are never torn across threads"_test = [] {
+        // every element of a published value holds the same number
+        using Value = std::array<u64, 64>;
+        constexpr u64 count = 200000;
+        TripleBuffer<Value> buffer;
+
+        std::thread writer{[&buffer] {
+            for (u64 i = 1; i <= count; ++i) {
+                buffer.write_buffer().fill(i);
+                buffer.publish();
+            }
+        }};
+
+        u64 last = 0;
+        bool torn = false;
+        bool backwards = false;
+        while (last < count) {
+            if (!buffer.update()) {
+                continue;
+            }
+            const auto &value = buffer.read_buffer();
+            for (const auto element : value) {
+                torn |= element != value[0];
+            }
+            backwards |= value[0] <= last;
+            last = value[0];
+        }
+        writer.join();
+
+        expect(!torn);
+        expect(!backwards);
+    };
+};
+
+int main() {}
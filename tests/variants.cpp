@@ -0,0 +1,179 @@
+#include <boost/ut.hpp>
+#include <vector>
+
+#include "../src/chip8.h"
+#include "../src/common.h"
+
+namespace {
+
+// the 128 pixel row with the low @param width bits of @param bits starting
+// at column @param x
+u128 row_bits(u128 bits, u32 width, u32 x) {
+    return (bits << (128 - width)) >> x;
+}
+
+template <typename Core> Core loaded(const std::vector<u8> &rom) {
+    Core core;
+    core.load_rom(rom);
+    return core;
+}
+
+} // namespace
+
+boost::ut::suite variants = [] {
+    using namespace boost::ut;
+
+    "check hires draws 16x16 sprites at full resolution"_test = [] {
+        std::vector<u8> rom{
+            0x00, 0xFF, // 200: hires
+            0xA2, 0x0C, // 202: I = 20C
+            0x60, 0x03, // 204: V0 = 3
+            0x61, 0x01, // 206: V1 = 1
+            0xD0, 0x10, // 208: draw 16x16 at V0, V1
+            0x12, 0x0A, // 20A: jump to self
+        };
+        rom.insert(rom.end(), 32, 0xFF);
+        auto chip8 = loaded<SuperChip>(rom);
+        chip8.run(5);
+
+        const auto &screen = chip8.screen();
+        expect(screen[0] == 0);
+        for (auto y = 1u; y <= 16; ++y) {
+            expect(screen[y] == row_bits(0xFFFF, 16, 3));
+        }
+        expect(screen[17] == 0);
+        expect(eq(chip8.V(0xF), 0));
+    };
+
+    "check lores doubles every pixel"_test = [] {
+        const std::vector<u8> rom{
+            0xA0, 0x50, // 200: I = font 0, F0 90 90 90 F0
+            0x60, 0x01, // 202: V0 = 1
+            0x61, 0x01, // 204: V1 = 1
+            0xD0, 0x15, // 206: draw 5 rows at V0, V1
+        };
+        auto chip8 = loaded<SuperChip>(rom);
+        chip8.run(4);
+
+        const auto &screen = chip8.screen();
+        expect(screen[1] == 0);
+        expect(screen[2] == row_bits(0xFF00, 16, 2));
+        expect(screen[3] == row_bits(0xFF00, 16, 2));
+        expect(screen[4] == row_bits(0xC300, 16, 2));
+        expect(screen[11] == row_bits(0xFF00, 16, 2));
+        expect(screen[12] == 0);
+    };
+
+    "check scrolling moves the screen"_test = [] {
+        const std::vector<u8> rom{
+            0x00, 0xFF, // 200: hires
+            0xA0, 0x50, // 202: I = font 0
+            0xD0, 0x01, // 204: draw 1 row at 0, 0
+            0x00, 0xC2, // 206: scroll down 2
+            0x00, 0xFB, // 208: scroll right 4
+        };
+        auto chip8 = loaded<SuperChip>(rom);
+        chip8.run(4);
+        expect(chip8.screen()[0] == 0);
+        expect(chip8.screen()[2] == row_bits(0xF0, 8, 0));
+
+        chip8.run(1);
+        expect(chip8.screen()[2] == row_bits(0xF0, 8, 4));
+    };
+
+    "check XO-CHIP draws into the selected bitplanes"_test = [] {
+        const std::vector<u8> rom{
+            0x00, 0xFF, // 200: hires
+            0xF2, 0x01, // 202: select plane 2
+            0xA2, 0x10, // 204: I = 210
+            0xD0, 0x01, // 206: draw 1 row at 0, 0 into plane 2
+            0xF3, 0x01, // 208: select both planes
+            0x61, 0x01, // 20A: V1 = 1
+            0xD0, 0x11, // 20C: draw 1 row at 0, 1 into both planes
+            0x12, 0x0E, // 20E: jump to self
+            0x80, 0x01, // 210: sprite data, one row per plane
+        };
+        auto chip8 = loaded<XoChip>(rom);
+        chip8.run(7);
+
+        const auto &screen = chip8.screen();
+        const auto second_plane = XoChip::SCREEN_HEIGHT;
+        expect(screen[0] == 0);
+        expect(screen[second_plane] == row_bits(0x80, 8, 0));
+        expect(screen[1] == row_bits(0x80, 8, 0));
+        expect(screen[second_plane + 1] == row_bits(0x01, 8, 0));
+    };
+
+    "check F000 loads a 16-bit I and is skipped as one instruction"_test =
+        [] {
+            const std::vector<u8> rom{
+                0x60, 0x05, // 200: V0 = 5
+                0x30, 0x05, // 202: skip if V0 == 5
+                0xF0, 0x00, // 204: I = 0xFFF0, skipped with its second word
+                0xFF, 0xF0, // 206
+                0x61, 0x01, // 208: V1 = 1
+                0xF0, 0x00, // 20A: I = 0xFFF0
+                0xFF, 0xF0, // 20C
+                0xF1, 0x55, // 20E: store V0, V1 at 0xFFF0
+            };
+            auto chip8 = loaded<XoChip>(rom);
+            chip8.run(3);
+            expect(eq(chip8.pc(), 0x20A));
+            expect(eq(chip8.I(), 0));
+            expect(eq(chip8.V(1), 1));
+
+            chip8.run(1);
+            expect(eq(chip8.I(), 0xFFF0));
+            chip8.run(1);
+            expect(eq(chip8.memory()[0xFFF0], 5));
+            expect(eq(chip8.memory()[0xFFF1], 1));
+        };
+
+    "check 5XY2 and 5XY3 store and load register ranges"_test = [] {
+        const std::vector<u8> rom{
+            0x61, 0x11, // 200: V1 = 0x11
+            0x62, 0x22, // 202: V2 = 0x22
+            0x63, 0x33, // 204: V3 = 0x33
+            0xA3, 0x00, // 206: I = 300
+            0x51, 0x32, // 208: store V1 to V3 at I
+            0x56, 0x43, // 20A: load V6 down to V4 from I
+        };
+        auto chip8 = loaded<XoChip>(rom);
+        chip8.run(6);
+        expect(eq(chip8.memory()[0x300], 0x11));
+        expect(eq(chip8.memory()[0x302], 0x33));
+        expect(eq(chip8.I(), 0x300));
+        expect(eq(chip8.V(6), 0x11));
+        expect(eq(chip8.V(5), 0x22));
+        expect(eq(chip8.V(4), 0x33));
+    };
+
+    "check blocks match the interpreter on every variant"_test = [] {
+        // scrolls and redraws in hires and lores
+        const std::vector<u8> rom{
+            0x00, 0xFF, // 200: hires
+            0xA0, 0x50, // 202: I = font start
+            0xD0, 0x15, // 204: draw 5 rows at V0, V1
+            0x70, 0x07, // 206: V0 += 7
+            0x00, 0xC1, // 208: scroll down 1
+            0x00, 0xFC, // 20A: scroll left 4
+            0x30, 0x38, // 20C: skip unless V0 == 0x38
+            0x00, 0xFE, // 20E: lores
+            0x12, 0x02, // 210: jump 202
+        };
+        const auto check = []<typename Core>(const std::vector<u8> &rom) {
+            auto interpreter = loaded<Core>(rom);
+            auto cached = loaded<Core>(rom);
+            cached.set_backend(Core::Backend::block_cache);
+            for (auto slice : {1u, 3u, 7u, 64u, 500u}) {
+                interpreter.run(slice);
+                cached.run(slice);
+                expect(interpreter.save_state() == cached.save_state());
+            }
+        };
+        check.template operator()<SuperChip>(rom);
+        check.template operator()<XoChip>(rom);
+    };
+};
+
+int main() {}